@@ -1,51 +1,123 @@
 #pragma once
 
 
+#include "node_pool.h"
+#include "augment.h"
+#include "parallel_for.h"
+
   // Node and forward declaration because g++ does
   // not understand nested classes.
-template <class Comparable>
+template <class Comparable, template <class> class NodePool = HeapNodePool,
+          class Augment = NoAugment>
 class AvlTree;
 
-template <class Comparable>
-class AvlNode
+  // The node derives from its summary so that an empty one takes no room.
+template <class Comparable, class Augment>
+class AvlNode : private Augment::value_type
 {
+    typedef typename Augment::value_type Summary;
+
     Comparable element;
     AvlNode   *left;
     AvlNode   *right;
     int        height;
+    int        size;      // Number of nodes in this subtree
 
     AvlNode( const Comparable & theElement, AvlNode *lt, AvlNode *rt, int h = 0 )
-      : element( theElement ), left( lt ), right( rt ), height( h ) { }
-    friend class AvlTree<Comparable>;
+      : element( theElement ), left( lt ), right( rt ), height( h )
+      { update( ); }
+    AvlNode( Comparable && theElement, AvlNode *lt, AvlNode *rt, int h = 0 )
+      : element( std::move( theElement ) ), left( lt ), right( rt ), height( h )
+      { update( ); }
+
+        // Summary of the items in this subtree
+    const Summary & summary( ) const
+      { return *this; }
+
+        // Recompute size and summary from the children
+    void update( )
+    {
+        size = 1 + sizeOf( left ) + sizeOf( right );
+        static_cast<Summary &>( *this ) =
+            Augment::combine( Augment::combine( summaryOf( left ), Augment::of( element ) ),
+                              summaryOf( right ) );
+    }
+
+    static int sizeOf( AvlNode *t )
+      { return t == NULL ? 0 : t->size; }
+    static Summary summaryOf( AvlNode *t )
+      { return t == NULL ? Summary( ) : t->summary( ); }
+    template <class C, template <class> class P, class A> friend class AvlTree;
+    friend class HeapNodePool<AvlNode>;
+    friend class ArenaNodePool<AvlNode>;
 };
 
 #include <iostream>       // For NULL
 #include <functional>
 #include <list>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <cstddef>
 
 // AvlTree class
 //
 // CONSTRUCTION: with ITEM_NOT_FOUND object used to signal failed finds
+// NodePool is the node allocation policy, HeapNodePool (new and delete per
+// node) by default or ArenaNodePool (nodes carved out of large blocks); see
+// node_pool.h
+// Augment is a monoid whose summary each node keeps for its subtree,
+// NoAugment (nothing) by default; see augment.h
 //
 // ******************PUBLIC OPERATIONS*********************
 // void insert( x )       --> Insert x
-// void remove( x )       --> Remove x (unimplemented)
+// int remove( x )        --> Remove x; returns 1 if it was present, else 0
+// int removeIf( p )      --> Remove all items that satisfy p, rebuilding the
+//                            tree from the rest in linear time; returns count removed
 // Comparable find( x )   --> Return item that matches x
 // Comparable findMin( )  --> Return smallest item
 // Comparable findMax( )  --> Return largest item
-// list<Comparable&> findAllIf (p,q)--> returns a list of all items that statisfy p; goes through tree with q ordering (eg numeric order)
-// q returns 1,0, -1. a 1 means go down right subtree, -1 means go left, 0 means dont go anywhere
 // boolean isEmpty( )     --> Return true if empty; else false
 // void makeEmpty( )      --> Remove all items
 // void printTree( )      --> Print tree in sorted order
+// void visitInOrder( v ) --> Call v on every item in sorted order
+// void visitRange( lo, hi, v ) --> Call v on every item from lo to hi, inclusive,
+//                            in sorted order, skipping subtrees outside the range
+// void buildFromSorted( first, last ) --> Replace contents with sorted, distinct items
+// int insertSorted( first, last ) --> Insert sorted, distinct items; returns count added
+// int countIf( p )      --> Return the number of items that satisfy p
+// list<Comparable> collectIntoListIf( p ) --> Return the items that satisfy p, largest first
+// int parallelCountIf( p, n ), list<Comparable> parallelCollectIntoListIf( p, n )
+//                        --> The same on up to n threads; p must be safe to call
+//                            concurrently. Small trees are done sequentially.
+// Predicates and visitors may be any callable taking a const Comparable &;
+// they are passed by reference and can be inlined.
+// const_iterator begin( ), end( ) --> Bidirectional iterators in sorted order
+// rbegin( ), rend( )     --> The same in reverse order
+// int size( )            --> Return the number of items
+// int height( )          --> Return the height of the tree, -1 if empty
+// bool isBalanced( )     --> Return true if every node meets the AVL condition
+//                            and holds its true height and size; takes O(n) time
+// int rank( x )          --> Return the number of items less than x
+// Comparable select( k ) --> Return the item of rank k, or ITEM_NOT_FOUND
+// int countRange( lo, hi ) --> Return the number of items from lo to hi, inclusive
+// Summary summary( )     --> Return the summary of all items
+// Summary summarizeRange( lo, hi ) --> Return the summary of the items from lo
+//                            to hi, inclusive
+// The last five take O(log n) time, using the subtree size or summary in each node.
+// const_iterator lower_bound( x ) --> First item not less than x, or end( )
+// const_iterator upper_bound( x ) --> First item greater than x, or end( )
+// Iterators are invalidated by any change to the tree.
 
 
 using namespace std;
 
-template <class Comparable>
+template <class Comparable, template <class> class NodePool, class Augment>
 class AvlTree
 {
   public:
+    typedef typename Augment::value_type Summary;
+
     explicit AvlTree( const Comparable & notFound );
     AvlTree( const AvlTree & rhs );
     ~AvlTree( );
@@ -53,47 +125,215 @@ class AvlTree
     const Comparable & findMin( ) const;
     const Comparable & findMax( ) const;
     const Comparable & find( const Comparable & x ) const;
-    std::list<std::reference_wrapper<Comparable> > findAllIf( std::function<bool (Comparable)> p, std::function<int (Comparable)> q) const;
 
-    int countIf( std::function<bool(Comparable)> p ) const;
-    std::list<Comparable> collectIntoListIf( std::function<bool (Comparable)> p ) const;
+    template <class Predicate>
+    int countIf( const Predicate & p ) const;
+    template <class Predicate>
+    std::list<Comparable> collectIntoListIf( const Predicate & p ) const;
+    template <class Predicate>
+    int parallelCountIf( const Predicate & p, unsigned numThreads ) const;
+    template <class Predicate>
+    std::list<Comparable> parallelCollectIntoListIf( const Predicate & p, unsigned numThreads ) const;
     bool isEmpty( ) const;
+    int size( ) const;
+    int height( ) const;
+    bool isBalanced( ) const;
+    int rank( const Comparable & x ) const;
+    const Comparable & select( int k ) const;
+    int countRange( const Comparable & lo, const Comparable & hi ) const;
+    Summary summary( ) const;
+    Summary summarizeRange( const Comparable & lo, const Comparable & hi ) const;
     void printTree( ) const;
     std::ostream& printTreeToStream( std::ostream& os ) const;
+    template <class Visitor>
+    void visitInOrder( Visitor && v ) const;
+    template <class Visitor>
+    void visitRange( const Comparable & lo, const Comparable & hi, Visitor && v ) const;
     
 
     void makeEmpty( );
     int insert( const Comparable & x );
-    void remove( const Comparable & x );
+    template <class RandomIt>
+    void buildFromSorted( RandomIt first, RandomIt last );
+    template <class RandomIt>
+    int insertSorted( RandomIt first, RandomIt last );
+    int remove( const Comparable & x );
+    template <class Predicate>
+    int removeIf( const Predicate & p );
 
     const AvlTree & operator=( const AvlTree & rhs );
+
+    /**
+     * Bidirectional iterator over the items in sorted order. It keeps the
+     * path from the root to the current node on a fixed stack, so nodes
+     * need no parent pointers and iterating allocates nothing. An AVL
+     * tree of height 64 would hold more items than memory can.
+     */
+    class const_iterator
+    {
+      public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Comparable                      value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const Comparable *              pointer;
+        typedef const Comparable &              reference;
+
+        const_iterator( ) : root( NULL ), depth( 0 ) { }
+
+        const_iterator( const const_iterator & rhs )
+          : root( rhs.root ), depth( rhs.depth )
+        {
+            for( int i = 0; i < depth; ++i )
+                path[ i ] = rhs.path[ i ];
+        }
+
+        const_iterator & operator=( const const_iterator & rhs )
+        {
+            root = rhs.root;
+            depth = rhs.depth;
+            for( int i = 0; i < depth; ++i )
+                path[ i ] = rhs.path[ i ];
+            return *this;
+        }
+
+        reference operator*( ) const
+          { return path[ depth - 1 ]->element; }
+        pointer operator->( ) const
+          { return &path[ depth - 1 ]->element; }
+
+        const_iterator & operator++( )
+        {
+            AvlNode<Comparable, Augment> *t = path[ depth - 1 ];
+            if( t->right != NULL )
+                pushLeftmost( t->right );
+            else
+            {
+                    // Climb while coming up from a right child
+                --depth;
+                while( depth > 0 && path[ depth - 1 ]->right == t )
+                    t = path[ --depth ];
+            }
+            return *this;
+        }
+
+        const_iterator & operator--( )
+        {
+            if( depth == 0 )    // end( ); go to the largest item
+            {
+                if( root != NULL )
+                    pushRightmost( root );
+                return *this;
+            }
+            AvlNode<Comparable, Augment> *t = path[ depth - 1 ];
+            if( t->left != NULL )
+                pushRightmost( t->left );
+            else
+            {
+                --depth;
+                while( depth > 0 && path[ depth - 1 ]->left == t )
+                    t = path[ --depth ];
+            }
+            return *this;
+        }
+
+        const_iterator operator++( int )
+          { const_iterator old = *this; ++*this; return old; }
+        const_iterator operator--( int )
+          { const_iterator old = *this; --*this; return old; }
+
+        bool operator==( const const_iterator & rhs ) const
+          { return current( ) == rhs.current( ); }
+        bool operator!=( const const_iterator & rhs ) const
+          { return current( ) != rhs.current( ); }
+
+      private:
+        enum { MAX_DEPTH = 64 };
+
+        AvlNode<Comparable, Augment> *root;
+        AvlNode<Comparable, Augment> *path[ MAX_DEPTH ];
+        int depth;
+
+        explicit const_iterator( AvlNode<Comparable, Augment> *r ) : root( r ), depth( 0 ) { }
+
+        AvlNode<Comparable, Augment> * current( ) const
+          { return depth == 0 ? NULL : path[ depth - 1 ]; }
+
+        void pushLeftmost( AvlNode<Comparable, Augment> *t )
+        {
+            for( ; t != NULL; t = t->left )
+                path[ depth++ ] = t;
+        }
+
+        void pushRightmost( AvlNode<Comparable, Augment> *t )
+        {
+            for( ; t != NULL; t = t->right )
+                path[ depth++ ] = t;
+        }
+
+        friend class AvlTree;
+    };
+
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    const_iterator begin( ) const;
+    const_iterator end( ) const;
+    const_reverse_iterator rbegin( ) const
+      { return const_reverse_iterator( end( ) ); }
+    const_reverse_iterator rend( ) const
+      { return const_reverse_iterator( begin( ) ); }
+    const_iterator lower_bound( const Comparable & x ) const;
+    const_iterator upper_bound( const Comparable & x ) const;
     
   private:
-    AvlNode<Comparable> *root;
+    AvlNode<Comparable, Augment> *root;
+    NodePool<AvlNode<Comparable, Augment> > pool;
 
     const Comparable ITEM_NOT_FOUND;
 
-    const Comparable & elementAt( AvlNode<Comparable> *t ) const;
+    const Comparable & elementAt( AvlNode<Comparable, Augment> *t ) const;
 
-    int insert( const Comparable & x, AvlNode<Comparable> * & t ) const;
-    AvlNode<Comparable> * findMin( AvlNode<Comparable> *t ) const;
-    AvlNode<Comparable> * findMax( AvlNode<Comparable> *t ) const;
-    AvlNode<Comparable> * find( const Comparable & x, AvlNode<Comparable> *t ) const;
-    std::list<std::reference_wrapper<Comparable> > findAllIf( std::function<bool (Comparable)> p, std::function<int (Comparable)> q, AvlNode<Comparable> *t ) const;
-    void makeEmpty( AvlNode<Comparable> * & t ) const;
-    void printTree( AvlNode<Comparable> *t ) const;
-    std::ostream& printTreeToStream( std::ostream& os, AvlNode<Comparable> *t ) const;
-    AvlNode<Comparable> * clone( AvlNode<Comparable> *t ) const;
-    int countIf( std::function<bool(Comparable)> p, AvlNode<Comparable> *t) const;
-    std::list<Comparable> collectIntoListIf( std::function<bool (Comparable)> p, AvlNode<Comparable> *t ) const;
+    int insert( const Comparable & x, AvlNode<Comparable, Augment> * & t );
+    int remove( const Comparable & x, AvlNode<Comparable, Augment> * & t );
+    void balance( AvlNode<Comparable, Augment> * & t ) const;
+    AvlNode<Comparable, Augment> * findMin( AvlNode<Comparable, Augment> *t ) const;
+    AvlNode<Comparable, Augment> * findMax( AvlNode<Comparable, Augment> *t ) const;
+    AvlNode<Comparable, Augment> * find( const Comparable & x, AvlNode<Comparable, Augment> *t ) const;
+    void makeEmpty( AvlNode<Comparable, Augment> * & t );
+    void printTree( AvlNode<Comparable, Augment> *t ) const;
+    std::ostream& printTreeToStream( std::ostream& os, AvlNode<Comparable, Augment> *t ) const;
+    template <class Visitor>
+    void visitInOrder( Visitor & v, AvlNode<Comparable, Augment> *t ) const;
+    template <class Visitor>
+    void visitRange( const Comparable & lo, const Comparable & hi, Visitor & v,
+                     AvlNode<Comparable, Augment> *t ) const;
+    AvlNode<Comparable, Augment> * clone( AvlNode<Comparable, Augment> *t );
+    template <class RandomIt>
+    AvlNode<Comparable, Augment> * buildBalanced( RandomIt first, RandomIt last );
+    template <class Predicate>
+    int countIf( const Predicate & p, AvlNode<Comparable, Augment> *t ) const;
+    template <class Predicate>
+    void collectIntoListIf( const Predicate & p, AvlNode<Comparable, Augment> *t, std::list<Comparable> & l ) const;
+
+        // Parallel traversal: a part is a whole subtree (t, true) or the
+        // single node t (t, false)
+    enum { MIN_PART = 8192, PARTS_PER_THREAD = 8 };
+    typedef std::pair<AvlNode<Comparable, Augment> *, bool> Part;
+    bool runsInParallel( unsigned numThreads ) const;
+    std::vector<Part> splitInOrder( unsigned numThreads ) const;
+    void splitInOrder( AvlNode<Comparable, Augment> *t, int cutoff, std::vector<Part> & parts ) const;
 
         // Avl manipulations
-    int height( AvlNode<Comparable> *t ) const;
+    int height( AvlNode<Comparable, Augment> *t ) const;
+    int size( AvlNode<Comparable, Augment> *t ) const;
+    bool isBalanced( AvlNode<Comparable, Augment> *t ) const;
+    int countNotGreater( const Comparable & x ) const;
+    Summary summarizeRange( const Comparable & lo, const Comparable & hi,
+                            AvlNode<Comparable, Augment> *t, bool allAboveLo, bool allBelowHi ) const;
     int max( int lhs, int rhs ) const;
-    void rotateWithLeftChild( AvlNode<Comparable> * & k2 ) const;
-    void rotateWithRightChild( AvlNode<Comparable> * & k1 ) const;
-    void doubleWithLeftChild( AvlNode<Comparable> * & k3 ) const;
-    void doubleWithRightChild( AvlNode<Comparable> * & k1 ) const;
+    void rotateWithLeftChild( AvlNode<Comparable, Augment> * & k2 ) const;
+    void rotateWithRightChild( AvlNode<Comparable, Augment> * & k1 ) const;
+    void doubleWithLeftChild( AvlNode<Comparable, Augment> * & k3 ) const;
+    void doubleWithRightChild( AvlNode<Comparable, Augment> * & k1 ) const;
 };
 
 // #include "AvlTree.cpp"
@@ -107,8 +347,8 @@ class AvlTree
 /**
  * Construct the tree.
  */
-template <class Comparable>
-AvlTree<Comparable>::AvlTree( const Comparable & notFound ) :
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlTree<Comparable, NodePool, Augment>::AvlTree( const Comparable & notFound ) :
   root( NULL ), ITEM_NOT_FOUND( notFound )
 {
 }
@@ -116,8 +356,8 @@ AvlTree<Comparable>::AvlTree( const Comparable & notFound ) :
 /**
  * Copy constructor.
  */
-template <class Comparable>
-AvlTree<Comparable>::AvlTree( const AvlTree<Comparable> & rhs ) :
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlTree<Comparable, NodePool, Augment>::AvlTree( const AvlTree<Comparable, NodePool, Augment> & rhs ) :
   ITEM_NOT_FOUND( rhs.ITEM_NOT_FOUND ), root( NULL )
 {
     *this = rhs;
@@ -126,8 +366,8 @@ AvlTree<Comparable>::AvlTree( const AvlTree<Comparable> & rhs ) :
 /**
  * Destructor for the tree.
  */
-template <class Comparable>
-AvlTree<Comparable>::~AvlTree( )
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlTree<Comparable, NodePool, Augment>::~AvlTree( )
 {
     makeEmpty( );
 }
@@ -135,28 +375,52 @@ AvlTree<Comparable>::~AvlTree( )
 /**
  * Insert x into the tree; duplicates are ignored.
  */
-template <class Comparable>
-int AvlTree<Comparable>::insert( const Comparable & x )
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::insert( const Comparable & x )
 {
     return insert( x, root );
 }
 
 /**
  * Remove x from the tree. Nothing is done if x is not found.
+ * Return 1 if x was removed, 0 otherwise.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::remove( const Comparable & x )
+{
+    return remove( x, root );
+}
+
+/**
+ * Remove every item that satisfies p. The survivors are collected in
+ * order and the tree is rebuilt from them in linear time, which beats
+ * removing many items one at a time.
+ * Return the number of items removed.
  */
-template <class Comparable>
-void AvlTree<Comparable>::remove( const Comparable & x )
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int AvlTree<Comparable, NodePool, Augment>::removeIf( const Predicate & p )
 {
-    cout << "Sorry, remove unimplemented; " << x <<
-          " still present" << endl;
+    std::vector<Comparable> kept;
+    int removed = 0;
+    visitInOrder( [&]( const Comparable & x ) {
+        if( p( x ) )
+            ++removed;
+        else
+            kept.push_back( x );
+    } );
+    if( removed > 0 )
+        buildFromSorted( std::make_move_iterator( kept.begin( ) ),
+                         std::make_move_iterator( kept.end( ) ) );
+    return removed;
 }
 
 /**
  * Find the smallest item in the tree.
  * Return smallest item or ITEM_NOT_FOUND if empty.
  */
-template <class Comparable>
-const Comparable & AvlTree<Comparable>::findMin( ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable & AvlTree<Comparable, NodePool, Augment>::findMin( ) const
 {
     return elementAt( findMin( root ) );
 }
@@ -165,8 +429,8 @@ const Comparable & AvlTree<Comparable>::findMin( ) const
  * Find the largest item in the tree.
  * Return the largest item of ITEM_NOT_FOUND if empty.
  */
-template <class Comparable>
-const Comparable & AvlTree<Comparable>::findMax( ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable & AvlTree<Comparable, NodePool, Augment>::findMax( ) const
 {
     return elementAt( findMax( root ) );
 }
@@ -175,37 +439,269 @@ const Comparable & AvlTree<Comparable>::findMax( ) const
  * Find item x in the tree.
  * Return the matching item or ITEM_NOT_FOUND if not found.
  */
-template <class Comparable>
-const Comparable & AvlTree<Comparable>::
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable & AvlTree<Comparable, NodePool, Augment>::
                           find( const Comparable & x ) const
 {
     return elementAt( find( x, root ) );
 }
 
+/**
+ * Return an iterator to the smallest item, or end( ) if empty.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::const_iterator
+AvlTree<Comparable, NodePool, Augment>::begin( ) const
+{
+    const_iterator itr( root );
+    itr.pushLeftmost( root );
+    return itr;
+}
+
+/**
+ * Return the past-the-end iterator.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::const_iterator
+AvlTree<Comparable, NodePool, Augment>::end( ) const
+{
+    return const_iterator( root );
+}
+
+/**
+ * Return an iterator to the first item not less than x, or end( ).
+ * The path is kept down to the last node where the search went left,
+ * which is the answer.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::const_iterator
+AvlTree<Comparable, NodePool, Augment>::lower_bound( const Comparable & x ) const
+{
+    const_iterator itr( root );
+    int found = 0;
+    for( AvlNode<Comparable, Augment> *t = root; t != NULL; )
+    {
+        itr.path[ itr.depth++ ] = t;
+        if( t->element < x )
+            t = t->right;
+        else
+        {
+            found = itr.depth;
+            t = t->left;
+        }
+    }
+    itr.depth = found;
+    return itr;
+}
+
+/**
+ * Return an iterator to the first item greater than x, or end( ).
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::const_iterator
+AvlTree<Comparable, NodePool, Augment>::upper_bound( const Comparable & x ) const
+{
+    const_iterator itr( root );
+    int found = 0;
+    for( AvlNode<Comparable, Augment> *t = root; t != NULL; )
+    {
+        itr.path[ itr.depth++ ] = t;
+        if( x < t->element )
+        {
+            found = itr.depth;
+            t = t->left;
+        }
+        else
+            t = t->right;
+    }
+    itr.depth = found;
+    return itr;
+}
+
 /**
  * Make the tree logically empty.
  */
-template <class Comparable>
-void AvlTree<Comparable>::makeEmpty( )
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::makeEmpty( )
 {
-    makeEmpty( root );
+    if( NodePool<AvlNode<Comparable, Augment> >::CLEARS_ALL )
+    {
+        pool.clear( );    // No need to walk the tree
+        root = NULL;
+    }
+    else
+        makeEmpty( root );
 }
 
 /**
  * Test if the tree is logically empty.
  * Return true if empty, false otherwise.
  */
-template <class Comparable>
-bool AvlTree<Comparable>::isEmpty( ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+bool AvlTree<Comparable, NodePool, Augment>::isEmpty( ) const
 {
     return root == NULL;
 }
 
+/**
+ * Return the number of items in the tree.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::size( ) const
+{
+    return size( root );
+}
+
+/**
+ * Return the height of the tree: 0 for a single node, -1 if empty.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::height( ) const
+{
+    return height( root );
+}
+
+/**
+ * Return true if the heights of the subtrees of every node differ by at
+ * most one, and every node holds the height and size of its subtree.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+bool AvlTree<Comparable, NodePool, Augment>::isBalanced( ) const
+{
+    return isBalanced( root );
+}
+
+/**
+ * Return the number of items less than x. Every node where the search
+ * goes right adds itself and its left subtree.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::rank( const Comparable & x ) const
+{
+    int r = 0;
+    for( AvlNode<Comparable, Augment> *t = root; t != NULL; )
+        if( t->element < x )
+        {
+            r += size( t->left ) + 1;
+            t = t->right;
+        }
+        else
+            t = t->left;
+    return r;
+}
+
+/**
+ * Internal method to return the number of items not greater than x.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::countNotGreater( const Comparable & x ) const
+{
+    int r = 0;
+    for( AvlNode<Comparable, Augment> *t = root; t != NULL; )
+        if( x < t->element )
+            t = t->left;
+        else
+        {
+            r += size( t->left ) + 1;
+            t = t->right;
+        }
+    return r;
+}
+
+/**
+ * Return the item of rank k, the k-th smallest counting from 0,
+ * or ITEM_NOT_FOUND if k is out of range.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable & AvlTree<Comparable, NodePool, Augment>::select( int k ) const
+{
+    AvlNode<Comparable, Augment> *t = root;
+    while( t != NULL )
+    {
+        int leftSize = size( t->left );
+        if( k < leftSize )
+            t = t->left;
+        else if( k > leftSize )
+        {
+            k -= leftSize + 1;
+            t = t->right;
+        }
+        else
+            break;
+    }
+    return elementAt( t );
+}
+
+/**
+ * Return the number of items x with lo <= x <= hi.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::countRange( const Comparable & lo, const Comparable & hi ) const
+{
+    if( hi < lo )
+        return 0;
+    return countNotGreater( hi ) - rank( lo );
+}
+
+/**
+ * Return the summary of all items in the tree.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::Summary
+AvlTree<Comparable, NodePool, Augment>::summary( ) const
+{
+    return AvlNode<Comparable, Augment>::summaryOf( root );
+}
+
+/**
+ * Return the summary of the items x with lo <= x <= hi, combined in
+ * sorted order.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::Summary
+AvlTree<Comparable, NodePool, Augment>::summarizeRange( const Comparable & lo,
+                                                        const Comparable & hi ) const
+{
+    if( hi < lo )
+        return Summary( );
+    return summarizeRange( lo, hi, root, false, false );
+}
+
+/**
+ * Internal method to summarize the items of subtree t in [lo,hi].
+ * allAboveLo and allBelowHi tell that an ancestor already bounds t on
+ * that side. Below the node where lo and hi part, each side follows one
+ * path and takes the subtrees inside the range whole, so O(log n) nodes
+ * are visited.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename AvlTree<Comparable, NodePool, Augment>::Summary
+AvlTree<Comparable, NodePool, Augment>::summarizeRange( const Comparable & lo, const Comparable & hi,
+                                                        AvlNode<Comparable, Augment> *t,
+                                                        bool allAboveLo, bool allBelowHi ) const
+{
+    while( t != NULL )
+    {
+        if( allAboveLo && allBelowHi )
+            return t->summary( );
+        if( !allAboveLo && t->element < lo )
+            t = t->right;
+        else if( !allBelowHi && hi < t->element )
+            t = t->left;
+        else
+            return Augment::combine(
+                Augment::combine( summarizeRange( lo, hi, t->left, allAboveLo, true ),
+                                  Augment::of( t->element ) ),
+                summarizeRange( lo, hi, t->right, true, allBelowHi ) );
+    }
+    return Summary( );
+}
+
 /**
  * Print the tree contents in sorted order.
  */
-template <class Comparable>
-void AvlTree<Comparable>::printTree( ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::printTree( ) const
 {
     if( isEmpty( ) )
         cout << "Empty tree" << endl;
@@ -216,10 +712,10 @@ void AvlTree<Comparable>::printTree( ) const
 /**
  * Deep copy.
  */
-template <class Comparable>
-const AvlTree<Comparable> &
-AvlTree<Comparable>::
-operator=( const AvlTree<Comparable> & rhs )
+template <class Comparable, template <class> class NodePool, class Augment>
+const AvlTree<Comparable, NodePool, Augment> &
+AvlTree<Comparable, NodePool, Augment>::
+operator=( const AvlTree<Comparable, NodePool, Augment> & rhs )
 {
     if( this != &rhs )
     {
@@ -229,12 +725,77 @@ operator=( const AvlTree<Comparable> & rhs )
     return *this;
 }
 
+/**
+ * Replace the contents of the tree with the items in [first,last), which
+ * must be sorted and contain no duplicates. The tree is built perfectly
+ * balanced in linear time.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class RandomIt>
+void AvlTree<Comparable, NodePool, Augment>::buildFromSorted( RandomIt first, RandomIt last )
+{
+    makeEmpty( );
+    root = buildBalanced( first, last );
+}
+
+/**
+ * Insert the items in [first,last), which must be sorted and contain no
+ * duplicates. Items already in the tree are kept and the matching new ones
+ * ignored, as insert does. The tree is rebuilt from the merged sequence in
+ * linear time. Return the number of items added.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class RandomIt>
+int AvlTree<Comparable, NodePool, Augment>::insertSorted( RandomIt first, RandomIt last )
+{
+    if( isEmpty( ) )
+    {
+        buildFromSorted( first, last );
+        return static_cast<int>( last - first );
+    }
+
+    std::vector<Comparable> merged;
+    int added = 0;
+    visitInOrder( [&]( const Comparable & x ) {
+        for( ; first != last && *first < x; ++first, ++added )
+            merged.push_back( *first );
+        if( first != last && !( x < *first ) )
+            ++first;    // Duplicate; keep the old item
+        merged.push_back( x );
+    } );
+    for( ; first != last; ++first, ++added )
+        merged.push_back( *first );
+
+    buildFromSorted( merged.begin( ), merged.end( ) );
+    return added;
+}
+
+/**
+ * Internal method to build a balanced subtree from sorted items.
+ * The middle item becomes the root, so heights differ by at most one.
+ * Return the root of the subtree.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class RandomIt>
+AvlNode<Comparable, Augment> *
+AvlTree<Comparable, NodePool, Augment>::buildBalanced( RandomIt first, RandomIt last )
+{
+    if( first == last )
+        return NULL;
+
+    RandomIt middle = first + ( last - first ) / 2;
+    AvlNode<Comparable, Augment> *left = buildBalanced( first, middle );
+    AvlNode<Comparable, Augment> *right = buildBalanced( middle + 1, last );
+    return pool.create( *middle, left, right,
+                        max( height( left ), height( right ) ) + 1 );
+}
+
 /**
  * Internal method to get element field in node t.
  * Return the element field or ITEM_NOT_FOUND if t is NULL.
  */
-template <class Comparable>
-const Comparable & AvlTree<Comparable>::elementAt( AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable & AvlTree<Comparable, NodePool, Augment>::elementAt( AvlNode<Comparable, Augment> *t ) const
 {
     return t == NULL ? ITEM_NOT_FOUND : t->element;
 }
@@ -244,12 +805,12 @@ const Comparable & AvlTree<Comparable>::elementAt( AvlNode<Comparable> *t ) cons
  * x is the item to insert.
  * t is the node that roots the tree.
  */
-template <class Comparable>
-int AvlTree<Comparable>::insert( const Comparable & x, AvlNode<Comparable> * & t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::insert( const Comparable & x, AvlNode<Comparable, Augment> * & t )
 {
     int result = 0;
     if( t == NULL ) {
-        t = new AvlNode<Comparable>( x, NULL, NULL );
+        t = pool.create( x, nullptr, nullptr );
         result = 1;
     }
     else if( x < t->element )
@@ -277,16 +838,75 @@ int AvlTree<Comparable>::insert( const Comparable & x, AvlNode<Comparable> * & t
     else
         ;  // Duplicate; do nothing
     t->height = max( height( t->left ), height( t->right ) ) + 1;
+    t->update( );
     return result;
 }
 
+/**
+ * Internal method to remove from a subtree.
+ * x is the item to remove.
+ * t is the node that roots the subtree.
+ * Return 1 if x was found and removed, 0 otherwise.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::remove( const Comparable & x, AvlNode<Comparable, Augment> * & t )
+{
+    if( t == NULL )
+        return 0;   // Item not found; do nothing
+
+    int result = 1;
+    if( x < t->element )
+        result = remove( x, t->left );
+    else if( t->element < x )
+        result = remove( x, t->right );
+    else if( t->left != NULL && t->right != NULL ) // Two children
+    {
+        t->element = findMin( t->right )->element;
+        remove( t->element, t->right );
+    }
+    else
+    {
+        AvlNode<Comparable, Augment> *oldNode = t;
+        t = ( t->left != NULL ) ? t->left : t->right;
+        pool.destroy( oldNode );
+        return 1;
+    }
+    balance( t );
+    return result;
+}
+
+/**
+ * Internal method to restore the AVL condition at t after one of its
+ * subtrees lost a node, then update its height.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::balance( AvlNode<Comparable, Augment> * & t ) const
+{
+    if( height( t->left ) - height( t->right ) > 1 )
+    {
+        if( height( t->left->left ) >= height( t->left->right ) )
+            rotateWithLeftChild( t );
+        else
+            doubleWithLeftChild( t );
+    }
+    else if( height( t->right ) - height( t->left ) > 1 )
+    {
+        if( height( t->right->right ) >= height( t->right->left ) )
+            rotateWithRightChild( t );
+        else
+            doubleWithRightChild( t );
+    }
+    t->height = max( height( t->left ), height( t->right ) ) + 1;
+    t->update( );
+}
+
 /**
  * Internal method to find the smallest item in a subtree t.
  * Return node containing the smallest item.
  */
-template <class Comparable>
-AvlNode<Comparable> *
-AvlTree<Comparable>::findMin( AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlNode<Comparable, Augment> *
+AvlTree<Comparable, NodePool, Augment>::findMin( AvlNode<Comparable, Augment> *t ) const
 {
     if( t == NULL)
         return t;
@@ -300,9 +920,9 @@ AvlTree<Comparable>::findMin( AvlNode<Comparable> *t ) const
  * Internal method to find the largest item in a subtree t.
  * Return node containing the largest item.
  */
-template <class Comparable>
-AvlNode<Comparable> *
-AvlTree<Comparable>::findMax( AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlNode<Comparable, Augment> *
+AvlTree<Comparable, NodePool, Augment>::findMax( AvlNode<Comparable, Augment> *t ) const
 {
     if( t == NULL )
         return t;
@@ -318,9 +938,9 @@ AvlTree<Comparable>::findMax( AvlNode<Comparable> *t ) const
  * t is the node that roots the tree.
  * Return node containing the matched item.
  */
-template <class Comparable>
-AvlNode<Comparable> *
-AvlTree<Comparable>::find( const Comparable & x, AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlNode<Comparable, Augment> *
+AvlTree<Comparable, NodePool, Augment>::find( const Comparable & x, AvlNode<Comparable, Augment> *t ) const
 {
     while( t != NULL )
         if( x < t->element )
@@ -336,14 +956,14 @@ AvlTree<Comparable>::find( const Comparable & x, AvlNode<Comparable> *t ) const
 /**
  * Internal method to make subtree empty.
  */
-template <class Comparable>
-void AvlTree<Comparable>::makeEmpty( AvlNode<Comparable> * & t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::makeEmpty( AvlNode<Comparable, Augment> * & t )
 {
     if( t != NULL )
     {
         makeEmpty( t->left );
         makeEmpty( t->right );
-        delete t;
+        pool.destroy( t );
     }
     t = NULL;
 }
@@ -351,30 +971,55 @@ void AvlTree<Comparable>::makeEmpty( AvlNode<Comparable> * & t ) const
 /**
  * Internal method to clone subtree.
  */
-template <class Comparable>
-AvlNode<Comparable> * AvlTree<Comparable>::clone( AvlNode<Comparable> * t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+AvlNode<Comparable, Augment> * AvlTree<Comparable, NodePool, Augment>::clone( AvlNode<Comparable, Augment> * t )
 {
     if( t == NULL )
         return NULL;
     else
-        return new AvlNode<Comparable>( t->element, clone( t->left ),
-                                      clone( t->right ), t->height );
+        return pool.create( t->element, clone( t->left ),
+                            clone( t->right ), t->height );
+}
+
+/**
+ * Return the number of nodes in subtree t, or 0, if NULL.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::size( AvlNode<Comparable, Augment> *t ) const
+{
+    return t == NULL ? 0 : t->size;
 }
 
 /**
  * Return the height of node t, or -1, if NULL.
  */
-template <class Comparable>
-int AvlTree<Comparable>::height( AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::height( AvlNode<Comparable, Augment> *t ) const
 {
     return t == NULL ? -1 : t->height;
 }
 
+/**
+ * Internal method to test the AVL condition, height and size of every
+ * node in subtree t; true if t is NULL.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+bool AvlTree<Comparable, NodePool, Augment>::isBalanced( AvlNode<Comparable, Augment> *t ) const
+{
+    if( t == NULL )
+        return true;
+    int diff = height( t->left ) - height( t->right );
+    return diff >= -1 && diff <= 1 &&
+           t->height == max( height( t->left ), height( t->right ) ) + 1 &&
+           t->size == size( t->left ) + size( t->right ) + 1 &&
+           isBalanced( t->left ) && isBalanced( t->right );
+}
+
 /**
  * Return maximum of lhs and rhs.
  */
-template <class Comparable>
-int AvlTree<Comparable>::max( int lhs, int rhs ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+int AvlTree<Comparable, NodePool, Augment>::max( int lhs, int rhs ) const
 {
     return lhs > rhs ? lhs : rhs;
 }
@@ -384,14 +1029,16 @@ int AvlTree<Comparable>::max( int lhs, int rhs ) const
  * For AVL trees, this is a single rotation for case 1.
  * Update heights, then set new root.
  */
-template <class Comparable>
-void AvlTree<Comparable>::rotateWithLeftChild( AvlNode<Comparable> * & k2 ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::rotateWithLeftChild( AvlNode<Comparable, Augment> * & k2 ) const
 {
-    AvlNode<Comparable> *k1 = k2->left;
+    AvlNode<Comparable, Augment> *k1 = k2->left;
     k2->left = k1->right;
     k1->right = k2;
     k2->height = max( height( k2->left ), height( k2->right ) ) + 1;
     k1->height = max( height( k1->left ), k2->height ) + 1;
+    k2->update( );
+    k1->update( );
     k2 = k1;
 }
 
@@ -400,14 +1047,16 @@ void AvlTree<Comparable>::rotateWithLeftChild( AvlNode<Comparable> * & k2 ) cons
  * For AVL trees, this is a single rotation for case 4.
  * Update heights, then set new root.
  */
-template <class Comparable>
-void AvlTree<Comparable>::rotateWithRightChild( AvlNode<Comparable> * & k1 ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::rotateWithRightChild( AvlNode<Comparable, Augment> * & k1 ) const
 {
-    AvlNode<Comparable> *k2 = k1->right;
+    AvlNode<Comparable, Augment> *k2 = k1->right;
     k1->right = k2->left;
     k2->left = k1;
     k1->height = max( height( k1->left ), height( k1->right ) ) + 1;
     k2->height = max( height( k2->right ), k1->height ) + 1;
+    k1->update( );
+    k2->update( );
     k1 = k2;
 }
 
@@ -417,8 +1066,8 @@ void AvlTree<Comparable>::rotateWithRightChild( AvlNode<Comparable> * & k1 ) con
  * For AVL trees, this is a double rotation for case 2.
  * Update heights, then set new root.
  */
-template <class Comparable>
-void AvlTree<Comparable>::doubleWithLeftChild( AvlNode<Comparable> * & k3 ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::doubleWithLeftChild( AvlNode<Comparable, Augment> * & k3 ) const
 {
     rotateWithRightChild( k3->left );
     rotateWithLeftChild( k3 );
@@ -430,8 +1079,8 @@ void AvlTree<Comparable>::doubleWithLeftChild( AvlNode<Comparable> * & k3 ) cons
  * For AVL trees, this is a double rotation for case 3.
  * Update heights, then set new root.
  */
-template <class Comparable>
-void AvlTree<Comparable>::doubleWithRightChild( AvlNode<Comparable> * & k1 ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::doubleWithRightChild( AvlNode<Comparable, Augment> * & k1 ) const
 {
     rotateWithLeftChild( k1->right );
     rotateWithRightChild( k1 );
@@ -441,8 +1090,8 @@ void AvlTree<Comparable>::doubleWithRightChild( AvlNode<Comparable> * & k1 ) con
  * Internal method to print a subtree in sorted order.
  * t points to the node that roots the tree.
  */
-template <class Comparable>
-void AvlTree<Comparable>::printTree( AvlNode<Comparable> *t ) const
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::printTree( AvlNode<Comparable, Augment> *t ) const
 {
     if( t != NULL )
     {
@@ -452,27 +1101,29 @@ void AvlTree<Comparable>::printTree( AvlNode<Comparable> *t ) const
     }
 }
 
-template <class Comparable>
-int AvlTree<Comparable>::countIf( std::function<bool(Comparable)> p ) const {
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int AvlTree<Comparable, NodePool, Augment>::countIf( const Predicate & p ) const {
   return countIf(p, root);
 }
 
-template <class Comparable>
-int AvlTree<Comparable>::countIf( std::function<bool(Comparable)> p, AvlNode<Comparable> *t ) const {
-  if ( NULL == t ) {
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int AvlTree<Comparable, NodePool, Augment>::countIf( const Predicate & p, AvlNode<Comparable, Augment> *t ) const {
+  if (NULL == t) {
     return 0;
   }
   return static_cast<int>(p(t->element)) + countIf(p, t->left) + countIf(p, t->right);
 }
 
-template <class Comparable>
-std::ostream& AvlTree<Comparable>::printTreeToStream( std::ostream& os ) const {
+template <class Comparable, template <class> class NodePool, class Augment>
+std::ostream& AvlTree<Comparable, NodePool, Augment>::printTreeToStream( std::ostream& os ) const {
   return printTreeToStream( os, root );
 }
 
-template <class Comparable>
+template <class Comparable, template <class> class NodePool, class Augment>
 std::ostream& 
-AvlTree<Comparable>::printTreeToStream( std::ostream& os, AvlNode<Comparable> *t ) const {
+AvlTree<Comparable, NodePool, Augment>::printTreeToStream( std::ostream& os, AvlNode<Comparable, Augment> *t ) const {
   if ( NULL == t ) {
     return os;
   }
@@ -482,71 +1133,167 @@ AvlTree<Comparable>::printTreeToStream( std::ostream& os, AvlNode<Comparable> *t
   return os;
 }
 
-template <class Comparable>
-std::list<Comparable> 
-AvlTree<Comparable>::collectIntoListIf( std::function<bool (Comparable)> p ) const {
-  return collectIntoListIf(p, root);
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void AvlTree<Comparable, NodePool, Augment>::visitInOrder( Visitor && v ) const {
+  visitInOrder( v, root );
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void 
+AvlTree<Comparable, NodePool, Augment>::visitInOrder( Visitor & v, AvlNode<Comparable, Augment> *t ) const {
+  if ( NULL == t ) {
+    return;
+  }
+  visitInOrder(v, t->left);
+  v(t->element);
+  visitInOrder(v, t->right);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void AvlTree<Comparable, NodePool, Augment>::visitRange( const Comparable & lo, const Comparable & hi,
+                                                Visitor && v ) const {
+  visitRange( lo, hi, v, root );
 }
 
-template <class Comparable>
+// A subtree left of a node below lo, or right of a node above hi, holds
+// nothing in range, so only O(log n + k) nodes are visited.
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void
+AvlTree<Comparable, NodePool, Augment>::visitRange( const Comparable & lo, const Comparable & hi,
+                                           Visitor & v, AvlNode<Comparable, Augment> *t ) const {
+  if ( NULL == t ) {
+    return;
+  }
+  bool aboveLo = !( t->element < lo );
+  bool belowHi = !( hi < t->element );
+  if ( aboveLo )
+    visitRange(lo, hi, v, t->left);
+  if ( aboveLo && belowHi )
+    v(t->element);
+  if ( belowHi )
+    visitRange(lo, hi, v, t->right);
+}
+
+// The items come out in descending order: the right subtree, then the
+// node, then the left subtree.
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
 std::list<Comparable> 
-AvlTree<Comparable>::collectIntoListIf( std::function<bool (Comparable)> p, AvlNode<Comparable> *t ) const {
+AvlTree<Comparable, NodePool, Augment>::collectIntoListIf( const Predicate & p ) const {
+  std::list<Comparable> l;
+  collectIntoListIf(p, root, l);
+  return l;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+void
+AvlTree<Comparable, NodePool, Augment>::collectIntoListIf( const Predicate & p, AvlNode<Comparable, Augment> *t, std::list<Comparable> & l ) const {
   if (NULL == t) {
-    std::list<Comparable> k;
-    return k;
-  } else {
-    if (p(t->element)) {
-      std::list<Comparable> l = collectIntoListIf(p,t->left);
-      l.splice(l.begin(), std::list<Comparable>(1,t->element));
-      l.splice(l.begin(), collectIntoListIf(p,t->right));
-      return l;
-    } else {
-      std::list<Comparable> l = collectIntoListIf(p,t->left);
-      l.splice(l.begin(), collectIntoListIf(p,t->right));
-      return l;
-    }
+    return;
   }
+  collectIntoListIf(p, t->right, l);
+  if (p(t->element)) {
+    l.push_back(t->element);
+  }
+  collectIntoListIf(p, t->left, l);
+}
+
+/**
+ * Return true if a traversal on numThreads threads is worth splitting:
+ * there is more than one thread and at least two parts' worth of nodes.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+bool AvlTree<Comparable, NodePool, Augment>::runsInParallel( unsigned numThreads ) const
+{
+    return numThreads > 1 && size( ) >= 2 * MIN_PART;
 }
 
-template <class Comparable>
-std::list<std::reference_wrapper<Comparable> > 
-AvlTree<Comparable>::findAllIf( std::function<bool (Comparable)> p, std::function<int (Comparable)> q) const {
-  return findAllIf(p,q,root);
+/**
+ * Cut the tree, in sorted order, into the subtrees of at most about
+ * size( ) / ( numThreads * PARTS_PER_THREAD ) nodes, but no fewer than
+ * MIN_PART, and the single nodes above them. Only the top levels are
+ * walked, as the subtrees below the cut are taken whole.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+std::vector<typename AvlTree<Comparable, NodePool, Augment>::Part>
+AvlTree<Comparable, NodePool, Augment>::splitInOrder( unsigned numThreads ) const
+{
+    int cutoff = max( MIN_PART, size( ) / static_cast<int>( numThreads * PARTS_PER_THREAD ) );
+    std::vector<Part> parts;
+    splitInOrder( root, cutoff, parts );
+    return parts;
 }
 
-template <class Comparable>
-std::list<std::reference_wrapper<Comparable> > 
-AvlTree<Comparable>::findAllIf( std::function<bool (Comparable)> p, std::function<int (Comparable)> q, AvlNode<Comparable> *t ) const {
-  if ( NULL == t ) {
-    return std::list<std::reference_wrapper<Comparable> >();
-  } else {
-    int result = q(t->element);
-    if (p(t->element)) {
-      std::list<std::reference_wrapper<Comparable> > l(1,t->element);
-      switch (result) {
-      case 1:
-        l.splice(l.begin(), findAllIf(p,q,t->right));
-        break;
-      
-      case -1:
-        l.splice(l.begin(), findAllIf(p,q,t->left));
-        break;
-
-      case 0:
-        return l;
-      }
-      return l;
-    } else {
-      switch (result) {
-        case 1:
-          return findAllIf(p,q,t->right);
-        
-        case -1:
-          return findAllIf(p,q,t->left);
-
-        default:
-          return std::list<std::reference_wrapper<Comparable> >();;
-      }
+template <class Comparable, template <class> class NodePool, class Augment>
+void AvlTree<Comparable, NodePool, Augment>::splitInOrder( AvlNode<Comparable, Augment> *t, int cutoff,
+                                                           std::vector<Part> & parts ) const
+{
+    if( t == NULL )
+        return;
+    if( t->size <= cutoff )
+    {
+        parts.push_back( Part( t, true ) );
+        return;
     }
-  }
+    splitInOrder( t->left, cutoff, parts );
+    parts.push_back( Part( t, false ) );
+    splitInOrder( t->right, cutoff, parts );
 }
+
+/**
+ * countIf on up to numThreads threads of the shared TaskPool. The parts
+ * are counted concurrently and their counts added up.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int AvlTree<Comparable, NodePool, Augment>::parallelCountIf( const Predicate & p,
+                                                             unsigned numThreads ) const
+{
+    if( !runsInParallel( numThreads ) )
+        return countIf( p );
+    std::vector<Part> parts = splitInOrder( numThreads );
+    std::vector<int> counts( parts.size( ) );
+    parallel_for( parts.size( ), size( ), numThreads, [&]( size_t i ) {
+        AvlNode<Comparable, Augment> *t = parts[ i ].first;
+        counts[ i ] = parts[ i ].second ? countIf( p, t ) : static_cast<int>( p( t->element ) );
+    } );
+    int count = 0;
+    for( int c : counts )
+        count += c;
+    return count;
+}
+
+/**
+ * collectIntoListIf on up to numThreads threads of the shared TaskPool.
+ * Each part collects its items into a list of its own, largest first, and
+ * the lists are joined from the last part to the first, so the result is
+ * the same as the sequential one.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+std::list<Comparable>
+AvlTree<Comparable, NodePool, Augment>::parallelCollectIntoListIf( const Predicate & p,
+                                                                   unsigned numThreads ) const
+{
+    if( !runsInParallel( numThreads ) )
+        return collectIntoListIf( p );
+    std::vector<Part> parts = splitInOrder( numThreads );
+    std::vector<std::list<Comparable> > lists( parts.size( ) );
+    parallel_for( parts.size( ), size( ), numThreads, [&]( size_t i ) {
+        AvlNode<Comparable, Augment> *t = parts[ i ].first;
+        if( parts[ i ].second )
+            collectIntoListIf( p, t, lists[ i ] );
+        else if( p( t->element ) )
+            lists[ i ].push_back( t->element );
+    } );
+    std::list<Comparable> l;
+    for( size_t i = parts.size( ); i-- > 0; )
+        l.splice( l.end( ), lists[ i ] );
+    return l;
+}
+
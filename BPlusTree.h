@@ -0,0 +1,1084 @@
+/*******************************************************************************
+  Title          : BPlusTree.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : A B+tree with the public operations of AvlTree
+  Purpose        : To hold many items per node, so that a search touches a
+                   handful of wide nodes instead of one node per level of a
+                   binary tree, and to keep the items in linked leaves so
+                   that a full scan reads them in order, leaf by leaf.
+  Usage          : BPlusTree<Tree, ArenaNodePool> trees( Tree() );
+                   TreeCollection uses it instead of AvlTree when built with
+                   -DTREE_COLLECTION_BPLUS
+  Build with     : -std=c++11
+*******************************************************************************/
+#ifndef _BPLUS_TREE_H_
+#define _BPLUS_TREE_H_
+
+#include <iostream>
+#include <algorithm>
+#include <list>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+
+#include "node_pool.h"
+#include "augment.h"
+#include "parallel_for.h"
+
+/** class BPlusTree
+ *  An ordered set of distinct items with the same public operations as
+ *  AvlTree (see AvlTree.h), so that either can be used by TreeCollection:
+ *  insert, remove, removeIf, find, findMin, findMax, countIf,
+ *  collectIntoListIf, parallelCountIf, parallelCollectIntoListIf,
+ *  visitInOrder, visitRange, printTree, printTreeToStream, buildFromSorted,
+ *  insertSorted, size, height, rank, select, countRange, summary,
+ *  summarizeRange, begin/end, rbegin/rend, lower_bound and upper_bound.
+ *
+ *  Every item sits in a leaf; the leaves are all at the same depth and are
+ *  linked in order both ways. An inner node holds up to INNER_KEYS
+ *  separator keys: child i holds the items not less than keys[i-1] and less
+ *  than keys[i]. It also keeps the number of items under each child, which
+ *  makes rank, select and countRange O(log n), and their Augment summary
+ *  (see augment.h), which does the same for summarizeRange. Nodes are
+ *  sized to about NODE_BYTES, and every node but the root is at least half
+ *  full.
+ *
+ *  Leaves hold whole items and inner nodes whole items as keys, so the
+ *  fanout depends on sizeof(Comparable), and for inner nodes on
+ *  sizeof(Summary) too. Whole Trees are large, so nodes of a few cache
+ *  lines would hold only a handful of them; NODE_BYTES is 4096 for that
+ *  reason. Even so, a search makes about log2(n) comparisons, as in
+ *  AvlTree, and comparing two Trees of different species reads both names
+ *  through their dictionaries. find is bound by those comparisons, and is
+ *  only somewhat faster than in AvlTree. The gain is in scans and
+ *  iteration, which read the leaves in order.
+ *
+ *  Comparable must be default constructible and movable, and is compared
+ *  with operator< only. Nodes come from NodePool, as in AvlTree; there are
+ *  two pools, one for leaves and one for inner nodes. Iterators are
+ *  invalidated by any change to the tree.
+ */
+template <class Comparable, template <class> class NodePool = HeapNodePool,
+          class Augment = NoAugment>
+class BPlusTree {
+  // the number of items in a leaf, or keys in an inner node
+  struct Node {
+    int count;
+    Node() : count(0) { }
+  };
+
+  struct Leaf;
+  struct Inner;
+
+public:
+  typedef typename Augment::value_type Summary;
+
+  enum {
+    NODE_BYTES = 4096,
+    LEAF_ITEMS = NODE_BYTES / sizeof(Comparable) < 4 ? 4
+               : NODE_BYTES / sizeof(Comparable),
+    INNER_KEYS = NODE_BYTES / (sizeof(Comparable) + sizeof(Summary) + 12) < 4 ? 4
+               : NODE_BYTES / (sizeof(Comparable) + sizeof(Summary) + 12),
+    MIN_ITEMS  = LEAF_ITEMS / 2,
+    MIN_KEYS   = (INNER_KEYS - 1) / 2
+  };
+
+  explicit BPlusTree( const Comparable& notFound );
+  BPlusTree( const BPlusTree& rhs );
+  ~BPlusTree();
+
+  const BPlusTree& operator=( const BPlusTree& rhs );
+
+  const Comparable& findMin() const;
+  const Comparable& findMax() const;
+  const Comparable& find( const Comparable& x ) const;
+
+  template <class Predicate>
+  int countIf( const Predicate& p ) const;
+  template <class Predicate>
+  std::list<Comparable> collectIntoListIf( const Predicate& p ) const;
+  template <class Predicate>
+  int parallelCountIf( const Predicate& p, unsigned num_threads ) const;
+  template <class Predicate>
+  std::list<Comparable> parallelCollectIntoListIf( const Predicate& p, unsigned num_threads ) const;
+  bool isEmpty() const { return root == NULL; }
+  int size() const { return items; }
+  // the number of levels above the leaves: 0 for a single leaf, -1 if empty
+  int height() const { return root == NULL ? -1 : levels; }
+  int rank( const Comparable& x ) const;
+  const Comparable& select( int k ) const;
+  int countRange( const Comparable& lo, const Comparable& hi ) const;
+  Summary summary() const;
+  Summary summarizeRange( const Comparable& lo, const Comparable& hi ) const;
+  void printTree() const;
+  std::ostream& printTreeToStream( std::ostream& os ) const;
+  template <class Visitor>
+  void visitInOrder( Visitor&& v ) const;
+  template <class Visitor>
+  void visitRange( const Comparable& lo, const Comparable& hi, Visitor&& v ) const;
+
+  void makeEmpty();
+  int insert( const Comparable& x );
+  template <class RandomIt>
+  void buildFromSorted( RandomIt first, RandomIt last );
+  template <class RandomIt>
+  int insertSorted( RandomIt first, RandomIt last );
+  int remove( const Comparable& x );
+  template <class Predicate>
+  int removeIf( const Predicate& p );
+
+  /** Bidirectional iterator over the items in sorted order: a leaf and a
+   *  position in it. end() has no leaf.
+   */
+  class const_iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Comparable                      value_type;
+    typedef std::ptrdiff_t                  difference_type;
+    typedef const Comparable*               pointer;
+    typedef const Comparable&               reference;
+
+    const_iterator() : tree(NULL), leaf(NULL), index(0) { }
+
+    reference operator*() const { return leaf->items[index]; }
+    pointer operator->() const { return &leaf->items[index]; }
+
+    const_iterator& operator++() {
+      if (++index == leaf->count) {
+        leaf = leaf->next;
+        index = 0;
+      }
+      return *this;
+    }
+
+    const_iterator& operator--() {
+      if (leaf == NULL) {    // end(); go to the largest item
+        leaf = tree->lastLeaf();
+        index = leaf == NULL ? 0 : leaf->count - 1;
+      } else if (index == 0) {
+        leaf = leaf->prev;
+        index = leaf->count - 1;
+      } else {
+        --index;
+      }
+      return *this;
+    }
+
+    const_iterator operator++( int ) { const_iterator old = *this; ++*this; return old; }
+    const_iterator operator--( int ) { const_iterator old = *this; --*this; return old; }
+
+    bool operator==( const const_iterator& rhs ) const {
+      return leaf == rhs.leaf && index == rhs.index;
+    }
+    bool operator!=( const const_iterator& rhs ) const { return !(*this == rhs); }
+
+  private:
+    const BPlusTree* tree;
+    const Leaf* leaf;
+    int index;
+
+    const_iterator( const BPlusTree* t, const Leaf* l, int i )
+      : tree(t), leaf(l), index(i) { }
+
+    friend class BPlusTree;
+  };
+
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  const_iterator begin() const { return const_iterator(this, firstLeaf(), 0); }
+  const_iterator end() const { return const_iterator(this, NULL, 0); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  const_iterator lower_bound( const Comparable& x ) const;
+  const_iterator upper_bound( const Comparable& x ) const;
+
+private:
+  struct Leaf : Node {
+    Leaf* prev;
+    Leaf* next;
+    Comparable items[LEAF_ITEMS];
+    Leaf() : prev(NULL), next(NULL) { }
+  };
+
+  struct Inner : Node {
+    Comparable keys[INNER_KEYS];
+    Node* children[INNER_KEYS + 1];
+    int sizes[INNER_KEYS + 1];    // items under each child
+    Summary summaries[INNER_KEYS + 1];
+  };
+
+  Node* root;
+  int levels;    // inner levels above the leaves
+  int items;
+  // parallel scans split the leaves into parts of at least MIN_PART
+  // items, PARTS_PER_THREAD for each thread if there are enough
+  enum { MIN_PART = 8192, PARTS_PER_THREAD = 8 };
+
+  NodePool<Leaf> leaves;
+  NodePool<Inner> inners;
+
+  const Comparable ITEM_NOT_FOUND;
+
+  static Leaf* asLeaf( Node* t ) { return static_cast<Leaf*>(t); }
+  static Inner* asInner( Node* t ) { return static_cast<Inner*>(t); }
+
+  // the child of t whose range holds x: the number of keys not greater than x
+  static int childFor( const Inner* t, const Comparable& x ) {
+    return std::upper_bound(t->keys, t->keys + t->count, x) - t->keys;
+  }
+
+  static int minCount( int level ) { return level == 0 ? MIN_ITEMS : MIN_KEYS; }
+
+  Leaf* firstLeaf() const;
+  Leaf* leafOf( int k ) const;
+  std::vector<const Leaf*> splitLeaves( unsigned num_threads ) const;
+  Leaf* lastLeaf() const;
+  const_iterator leafPosition( Leaf* leaf, int index ) const;
+  int countNotGreater( const Comparable& x ) const;
+  int subtreeSize( Node* t, int level ) const;
+  Summary summaryOf( Node* t, int level ) const;
+  void updateChild( Inner* parent, int i, int level );
+  Summary summarizeRange( const Comparable& lo, const Comparable& hi, Node* t, int level,
+                          bool allAboveLo, bool allBelowHi ) const;
+
+  int insert( const Comparable& x, Node* t, int level, Node*& right, Comparable& separator );
+  void splitLeaf( Leaf* leaf, int pos, const Comparable& x, Node*& right, Comparable& separator );
+  void insertChild( Inner* t, int i, Comparable& separator, Node* child, int childSize,
+                    const Summary& childSummary, Node*& right, Comparable& up );
+  int remove( const Comparable& x, Node* t, int level );
+  void fixUnderflow( Inner* parent, int i, int level );
+  void borrowFromLeft( Inner* parent, int i, int level );
+  void borrowFromRight( Inner* parent, int i, int level );
+  void merge( Inner* parent, int i, int level );
+  void makeEmpty( Node* t, int level );
+};
+
+template <class Comparable, template <class> class NodePool, class Augment>
+BPlusTree<Comparable, NodePool, Augment>::BPlusTree( const Comparable& notFound )
+  : root(NULL), levels(0), items(0), ITEM_NOT_FOUND(notFound) { }
+
+template <class Comparable, template <class> class NodePool, class Augment>
+BPlusTree<Comparable, NodePool, Augment>::BPlusTree( const BPlusTree& rhs )
+  : root(NULL), levels(0), items(0), ITEM_NOT_FOUND(rhs.ITEM_NOT_FOUND) {
+  *this = rhs;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+BPlusTree<Comparable, NodePool, Augment>::~BPlusTree() {
+  makeEmpty();
+}
+
+// A deep copy, rebuilt from the items of rhs in linear time.
+template <class Comparable, template <class> class NodePool, class Augment>
+const BPlusTree<Comparable, NodePool, Augment>&
+BPlusTree<Comparable, NodePool, Augment>::operator=( const BPlusTree& rhs ) {
+  if (this != &rhs) {
+    std::vector<Comparable> all(rhs.begin(), rhs.end());
+    buildFromSorted(std::make_move_iterator(all.begin()),
+                    std::make_move_iterator(all.end()));
+  }
+  return *this;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable& BPlusTree<Comparable, NodePool, Augment>::findMin() const {
+  return isEmpty() ? ITEM_NOT_FOUND : *begin();
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable& BPlusTree<Comparable, NodePool, Augment>::findMax() const {
+  return isEmpty() ? ITEM_NOT_FOUND : *--end();
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable& BPlusTree<Comparable, NodePool, Augment>::find( const Comparable& x ) const {
+  const_iterator it = lower_bound(x);
+  if (it == end() || x < *it)
+    return ITEM_NOT_FOUND;
+  return *it;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Leaf*
+BPlusTree<Comparable, NodePool, Augment>::firstLeaf() const {
+  Node* t = root;
+  for ( int level = levels; t != NULL && level > 0; --level )
+    t = asInner(t)->children[0];
+  return asLeaf(t);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Leaf*
+BPlusTree<Comparable, NodePool, Augment>::lastLeaf() const {
+  Node* t = root;
+  for ( int level = levels; t != NULL && level > 0; --level )
+    t = asInner(t)->children[t->count];
+  return asLeaf(t);
+}
+
+// index may be one past the last item of leaf, which is the first item of
+// the next leaf
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::const_iterator
+BPlusTree<Comparable, NodePool, Augment>::leafPosition( Leaf* leaf, int index ) const {
+  if (index == leaf->count)
+    return const_iterator(this, leaf->next, 0);
+  return const_iterator(this, leaf, index);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::const_iterator
+BPlusTree<Comparable, NodePool, Augment>::lower_bound( const Comparable& x ) const {
+  if (isEmpty())
+    return end();
+  Node* t = root;
+  for ( int level = levels; level > 0; --level )
+    t = asInner(t)->children[childFor(asInner(t), x)];
+  Leaf* leaf = asLeaf(t);
+  return leafPosition(leaf, std::lower_bound(leaf->items, leaf->items + leaf->count, x)
+                            - leaf->items);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::const_iterator
+BPlusTree<Comparable, NodePool, Augment>::upper_bound( const Comparable& x ) const {
+  if (isEmpty())
+    return end();
+  Node* t = root;
+  for ( int level = levels; level > 0; --level )
+    t = asInner(t)->children[childFor(asInner(t), x)];
+  Leaf* leaf = asLeaf(t);
+  return leafPosition(leaf, std::upper_bound(leaf->items, leaf->items + leaf->count, x)
+                            - leaf->items);
+}
+
+// The children left of the one searched hold only items less than x.
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::rank( const Comparable& x ) const {
+  if (isEmpty())
+    return 0;
+  int r = 0;
+  Node* t = root;
+  for ( int level = levels; level > 0; --level ) {
+    Inner* inner = asInner(t);
+    int i = childFor(inner, x);
+    for ( int j = 0; j < i; ++j )
+      r += inner->sizes[j];
+    t = inner->children[i];
+  }
+  Leaf* leaf = asLeaf(t);
+  return r + (std::lower_bound(leaf->items, leaf->items + leaf->count, x) - leaf->items);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::countNotGreater( const Comparable& x ) const {
+  if (isEmpty())
+    return 0;
+  int r = 0;
+  Node* t = root;
+  for ( int level = levels; level > 0; --level ) {
+    Inner* inner = asInner(t);
+    int i = childFor(inner, x);
+    for ( int j = 0; j < i; ++j )
+      r += inner->sizes[j];
+    t = inner->children[i];
+  }
+  Leaf* leaf = asLeaf(t);
+  return r + (std::upper_bound(leaf->items, leaf->items + leaf->count, x) - leaf->items);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+const Comparable& BPlusTree<Comparable, NodePool, Augment>::select( int k ) const {
+  if (k < 0 || k >= items)
+    return ITEM_NOT_FOUND;
+  Node* t = root;
+  for ( int level = levels; level > 0; --level ) {
+    Inner* inner = asInner(t);
+    int i = 0;
+    for ( ; k >= inner->sizes[i]; ++i )
+      k -= inner->sizes[i];
+    t = inner->children[i];
+  }
+  return asLeaf(t)->items[k];
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::countRange( const Comparable& lo, const Comparable& hi ) const {
+  if (hi < lo)
+    return 0;
+  return countNotGreater(hi) - rank(lo);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int BPlusTree<Comparable, NodePool, Augment>::countIf( const Predicate& p ) const {
+  int count = 0;
+  for ( const Leaf* leaf = firstLeaf(); leaf != NULL; leaf = leaf->next ) {
+    for ( int i = 0; i < leaf->count; ++i )
+      count += static_cast<int>(p(leaf->items[i]));
+  }
+  return count;
+}
+
+// The items come out in descending order, as they do from AvlTree.
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+std::list<Comparable>
+BPlusTree<Comparable, NodePool, Augment>::collectIntoListIf( const Predicate& p ) const {
+  std::list<Comparable> l;
+  for ( const Leaf* leaf = lastLeaf(); leaf != NULL; leaf = leaf->prev ) {
+    for ( int i = leaf->count; i-- > 0; ) {
+      if (p(leaf->items[i]))
+        l.push_back(leaf->items[i]);
+    }
+  }
+  return l;
+}
+
+// the leaf holding the item of rank k
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Leaf*
+BPlusTree<Comparable, NodePool, Augment>::leafOf( int k ) const {
+  Node* t = root;
+  for ( int level = levels; level > 0; --level ) {
+    Inner* inner = asInner(t);
+    int i = 0;
+    for ( ; k >= inner->sizes[i] && i < inner->count; ++i )
+      k -= inner->sizes[i];
+    t = inner->children[i];
+  }
+  return asLeaf(t);
+}
+
+// Part i of a parallel scan is the leaves from bounds[i] up to, but not
+// including, bounds[i+1]; the last bound is NULL, past the last leaf.
+// Parts start at the leaves of evenly spaced ranks, found by descending
+// the inner levels by subtree size, so each holds about the same number
+// of items and no leaf is visited twice.
+template <class Comparable, template <class> class NodePool, class Augment>
+std::vector<const typename BPlusTree<Comparable, NodePool, Augment>::Leaf*>
+BPlusTree<Comparable, NodePool, Augment>::splitLeaves( unsigned num_threads ) const {
+  size_t parts = std::min<size_t>(std::max(1u, num_threads) * PARTS_PER_THREAD,
+                                  items / MIN_PART);
+  std::vector<const Leaf*> bounds;
+  for ( size_t i = 0; i < parts; ++i ) {
+    const Leaf* leaf = leafOf(static_cast<int>(items * i / parts));
+    if (bounds.empty() || bounds.back() != leaf)
+      bounds.push_back(leaf);
+  }
+  bounds.push_back(NULL);
+  return bounds;
+}
+
+// countIf on up to num_threads threads of the shared TaskPool
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int BPlusTree<Comparable, NodePool, Augment>::parallelCountIf( const Predicate& p,
+                                                               unsigned num_threads ) const {
+  if (num_threads <= 1 || items < 2 * MIN_PART)
+    return countIf(p);
+  std::vector<const Leaf*> bounds = splitLeaves(num_threads);
+  std::vector<int> counts(bounds.size() - 1);
+  parallel_for(counts.size(), items, num_threads, [&]( size_t part ) {
+    for ( const Leaf* leaf = bounds[part]; leaf != bounds[part + 1]; leaf = leaf->next ) {
+      for ( int i = 0; i < leaf->count; ++i )
+        counts[part] += static_cast<int>(p(leaf->items[i]));
+    }
+  });
+  int count = 0;
+  for ( int c : counts )
+    count += c;
+  return count;
+}
+
+// Each part lists its items largest first, and the lists are joined from
+// the last part to the first, as collectIntoListIf would list them.
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+std::list<Comparable>
+BPlusTree<Comparable, NodePool, Augment>::parallelCollectIntoListIf( const Predicate& p,
+                                                                     unsigned num_threads ) const {
+  if (num_threads <= 1 || items < 2 * MIN_PART)
+    return collectIntoListIf(p);
+  std::vector<const Leaf*> bounds = splitLeaves(num_threads);
+  std::vector<std::list<Comparable> > lists(bounds.size() - 1);
+  parallel_for(lists.size(), items, num_threads, [&]( size_t part ) {
+    for ( const Leaf* leaf = bounds[part]; leaf != bounds[part + 1]; leaf = leaf->next ) {
+      for ( int i = 0; i < leaf->count; ++i ) {
+        if (p(leaf->items[i]))
+          lists[part].push_front(leaf->items[i]);
+      }
+    }
+  });
+  std::list<Comparable> l;
+  for ( size_t part = lists.size(); part-- > 0; )
+    l.splice(l.end(), lists[part]);
+  return l;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void BPlusTree<Comparable, NodePool, Augment>::visitInOrder( Visitor&& v ) const {
+  for ( const Leaf* leaf = firstLeaf(); leaf != NULL; leaf = leaf->next ) {
+    for ( int i = 0; i < leaf->count; ++i )
+      v(leaf->items[i]);
+  }
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Visitor>
+void BPlusTree<Comparable, NodePool, Augment>::visitRange( const Comparable& lo, const Comparable& hi,
+                                                  Visitor&& v ) const {
+  for ( const_iterator it = lower_bound(lo); it != end() && !(hi < *it); ++it )
+    v(*it);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::printTree() const {
+  if (isEmpty())
+    std::cout << "Empty tree" << std::endl;
+  else
+    visitInOrder([](const Comparable& x) { std::cout << x << std::endl; });
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+std::ostream& BPlusTree<Comparable, NodePool, Augment>::printTreeToStream( std::ostream& os ) const {
+  visitInOrder([&os](const Comparable& x) { os << x << "\n"; });
+  return os;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::makeEmpty() {
+  if (NodePool<Leaf>::CLEARS_ALL && NodePool<Inner>::CLEARS_ALL) {
+    leaves.clear();    // no need to walk the tree
+    inners.clear();
+  } else if (root != NULL) {
+    makeEmpty(root, levels);
+  }
+  root = NULL;
+  levels = 0;
+  items = 0;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::makeEmpty( Node* t, int level ) {
+  if (level == 0) {
+    leaves.destroy(asLeaf(t));
+    return;
+  }
+  for ( int i = 0; i <= t->count; ++i )
+    makeEmpty(asInner(t)->children[i], level - 1);
+  inners.destroy(asInner(t));
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::subtreeSize( Node* t, int level ) const {
+  if (level == 0)
+    return t->count;
+  int size = 0;
+  for ( int i = 0; i <= t->count; ++i )
+    size += asInner(t)->sizes[i];
+  return size;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Summary
+BPlusTree<Comparable, NodePool, Augment>::summaryOf( Node* t, int level ) const {
+  Summary sum;
+  if (level == 0) {
+    for ( int i = 0; i < t->count; ++i )
+      sum = Augment::combine(sum, Augment::of(asLeaf(t)->items[i]));
+  } else {
+    for ( int i = 0; i <= t->count; ++i )
+      sum = Augment::combine(sum, asInner(t)->summaries[i]);
+  }
+  return sum;
+}
+
+// Recomputes the summary of child i of parent, which is at the given level.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::updateChild( Inner* parent, int i, int level ) {
+  parent->summaries[i] = summaryOf(parent->children[i], level);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Summary
+BPlusTree<Comparable, NodePool, Augment>::summary() const {
+  return isEmpty() ? Summary() : summaryOf(root, levels);
+}
+
+/** Return the summary of the items x with lo <= x <= hi, combined in
+ *  sorted order.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Summary
+BPlusTree<Comparable, NodePool, Augment>::summarizeRange( const Comparable& lo,
+                                                          const Comparable& hi ) const {
+  if (isEmpty() || hi < lo)
+    return Summary();
+  return summarizeRange(lo, hi, root, levels, false, false);
+}
+
+// allAboveLo and allBelowHi tell that t is already bounded on that side.
+// The children strictly between the ones holding lo and hi are taken
+// whole, so only the two boundary paths are descended.
+template <class Comparable, template <class> class NodePool, class Augment>
+typename BPlusTree<Comparable, NodePool, Augment>::Summary
+BPlusTree<Comparable, NodePool, Augment>::summarizeRange( const Comparable& lo, const Comparable& hi,
+                                                          Node* t, int level,
+                                                          bool allAboveLo, bool allBelowHi ) const {
+  Summary sum;
+  if (level == 0) {
+    Leaf* leaf = asLeaf(t);
+    int first = allAboveLo ? 0 : std::lower_bound(leaf->items, leaf->items + leaf->count, lo)
+                                 - leaf->items;
+    int last = allBelowHi ? leaf->count
+                          : std::upper_bound(leaf->items, leaf->items + leaf->count, hi)
+                            - leaf->items;
+    for ( int i = first; i < last; ++i )
+      sum = Augment::combine(sum, Augment::of(leaf->items[i]));
+    return sum;
+  }
+  Inner* inner = asInner(t);
+  int first = allAboveLo ? 0 : childFor(inner, lo);
+  int last = allBelowHi ? inner->count : childFor(inner, hi);
+  for ( int i = first; i <= last; ++i ) {
+    bool aboveLo = allAboveLo || i > first;
+    bool belowHi = allBelowHi || i < last;
+    if (aboveLo && belowHi)
+      sum = Augment::combine(sum, inner->summaries[i]);
+    else
+      sum = Augment::combine(sum, summarizeRange(lo, hi, inner->children[i], level - 1,
+                                                 aboveLo, belowHi));
+  }
+  return sum;
+}
+
+/** Insert x; duplicates are ignored. Return 1 if x was added, else 0.
+ *  A full node splits in two on the way back up, and a split of the root
+ *  adds a level.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::insert( const Comparable& x ) {
+  if (isEmpty()) {
+    Leaf* leaf = leaves.create();
+    leaf->items[0] = x;
+    leaf->count = 1;
+    root = leaf;
+    items = 1;
+    return 1;
+  }
+  Node* right = NULL;
+  Comparable separator;
+  int added = insert(x, root, levels, right, separator);
+  if (right != NULL) {
+    Inner* top = inners.create();
+    top->count = 1;
+    top->keys[0] = std::move(separator);
+    top->children[0] = root;
+    top->children[1] = right;
+    top->sizes[0] = subtreeSize(root, levels);
+    top->sizes[1] = subtreeSize(right, levels);
+    top->summaries[0] = summaryOf(root, levels);
+    top->summaries[1] = summaryOf(right, levels);
+    root = top;
+    ++levels;
+  }
+  items += added;
+  return added;
+}
+
+// If t splits, right is set to its new right sibling and separator to the
+// smallest item under it.
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::insert( const Comparable& x, Node* t, int level,
+                                             Node*& right, Comparable& separator ) {
+  if (level == 0) {
+    Leaf* leaf = asLeaf(t);
+    int pos = std::lower_bound(leaf->items, leaf->items + leaf->count, x) - leaf->items;
+    if (pos < leaf->count && !(x < leaf->items[pos]))
+      return 0;    // duplicate
+    if (leaf->count == LEAF_ITEMS) {
+      splitLeaf(leaf, pos, x, right, separator);
+    } else {
+      std::move_backward(leaf->items + pos, leaf->items + leaf->count,
+                         leaf->items + leaf->count + 1);
+      leaf->items[pos] = x;
+      ++leaf->count;
+    }
+    return 1;
+  }
+
+  Inner* inner = asInner(t);
+  int i = childFor(inner, x);
+  Node* child = NULL;
+  Comparable childSeparator;
+  int added = insert(x, inner->children[i], level - 1, child, childSeparator);
+  inner->sizes[i] += added;
+  if (added > 0)
+    updateChild(inner, i, level - 1);
+  if (child != NULL) {
+    int childSize = subtreeSize(child, level - 1);
+    inner->sizes[i] -= childSize;
+    insertChild(inner, i, childSeparator, child, childSize, summaryOf(child, level - 1),
+                right, separator);
+  }
+  return added;
+}
+
+// Splits the full leaf while inserting x at pos: the first half of the
+// LEAF_ITEMS + 1 items stay, the rest move to a new leaf linked after it.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::splitLeaf( Leaf* leaf, int pos, const Comparable& x,
+                                                 Node*& right, Comparable& separator ) {
+  const int total = LEAF_ITEMS + 1;
+  const int kept = (total + 1) / 2;
+  Leaf* sibling = leaves.create();
+  for ( int j = kept; j < total; ++j ) {
+    Comparable& to = sibling->items[j - kept];
+    if (j < pos)
+      to = std::move(leaf->items[j]);
+    else if (j == pos)
+      to = x;
+    else
+      to = std::move(leaf->items[j - 1]);
+  }
+  if (pos < kept) {
+    std::move_backward(leaf->items + pos, leaf->items + kept - 1, leaf->items + kept);
+    leaf->items[pos] = x;
+  }
+  leaf->count = kept;
+  sibling->count = total - kept;
+
+  sibling->prev = leaf;
+  sibling->next = leaf->next;
+  if (leaf->next != NULL)
+    leaf->next->prev = sibling;
+  leaf->next = sibling;
+
+  right = sibling;
+  separator = sibling->items[0];
+}
+
+// Adds child, holding childSize items from separator up and summarized by
+// childSummary, just after child i of t. If t is full it is split around its middle key, which moves up:
+// right is set to the new sibling and up to that key.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::insertChild( Inner* t, int i, Comparable& separator,
+                                                            Node* child, int childSize,
+                                                            const Summary& childSummary,
+                                                            Node*& right, Comparable& up ) {
+  Inner* target = t;
+  if (t->count == INNER_KEYS) {
+    const int mid = INNER_KEYS / 2;
+    Inner* sibling = inners.create();
+    sibling->count = INNER_KEYS - mid - 1;
+    std::move(t->keys + mid + 1, t->keys + INNER_KEYS, sibling->keys);
+    std::copy(t->children + mid + 1, t->children + INNER_KEYS + 1, sibling->children);
+    std::copy(t->sizes + mid + 1, t->sizes + INNER_KEYS + 1, sibling->sizes);
+    std::copy(t->summaries + mid + 1, t->summaries + INNER_KEYS + 1, sibling->summaries);
+    up = std::move(t->keys[mid]);
+    t->count = mid;
+    right = sibling;
+    if (i > mid) {
+      target = sibling;
+      i -= mid + 1;
+    }
+  }
+  std::move_backward(target->keys + i, target->keys + target->count,
+                     target->keys + target->count + 1);
+  std::copy_backward(target->children + i + 1, target->children + target->count + 1,
+                     target->children + target->count + 2);
+  std::copy_backward(target->sizes + i + 1, target->sizes + target->count + 1,
+                     target->sizes + target->count + 2);
+  std::copy_backward(target->summaries + i + 1, target->summaries + target->count + 1,
+                     target->summaries + target->count + 2);
+  target->keys[i] = std::move(separator);
+  target->children[i + 1] = child;
+  target->sizes[i + 1] = childSize;
+  target->summaries[i + 1] = childSummary;
+  ++target->count;
+}
+
+/** Remove x. Return 1 if it was present, else 0. A node left less than
+ *  half full borrows an item from a sibling or merges with it, and a root
+ *  left with one child gives up its level.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::remove( const Comparable& x ) {
+  if (isEmpty() || remove(x, root, levels) == 0)
+    return 0;
+  --items;
+  if (levels == 0 && root->count == 0) {
+    leaves.destroy(asLeaf(root));
+    root = NULL;
+  } else if (levels > 0 && root->count == 0) {
+    Inner* top = asInner(root);
+    root = top->children[0];
+    inners.destroy(top);
+    --levels;
+  }
+  return 1;
+}
+
+// Separator keys are left alone when the item they copy is removed; they
+// still divide the children correctly.
+template <class Comparable, template <class> class NodePool, class Augment>
+int BPlusTree<Comparable, NodePool, Augment>::remove( const Comparable& x, Node* t, int level ) {
+  if (level == 0) {
+    Leaf* leaf = asLeaf(t);
+    int pos = std::lower_bound(leaf->items, leaf->items + leaf->count, x) - leaf->items;
+    if (pos == leaf->count || x < leaf->items[pos])
+      return 0;
+    std::move(leaf->items + pos + 1, leaf->items + leaf->count, leaf->items + pos);
+    leaf->items[--leaf->count] = Comparable();
+    return 1;
+  }
+  Inner* inner = asInner(t);
+  int i = childFor(inner, x);
+  if (remove(x, inner->children[i], level - 1) == 0)
+    return 0;
+  --inner->sizes[i];
+  if (inner->children[i]->count < minCount(level - 1))
+    fixUnderflow(inner, i, level - 1);
+  else
+    updateChild(inner, i, level - 1);
+  return 1;
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::fixUnderflow( Inner* parent, int i, int level ) {
+  if (i > 0 && parent->children[i - 1]->count > minCount(level))
+    borrowFromLeft(parent, i, level);
+  else if (i < parent->count && parent->children[i + 1]->count > minCount(level))
+    borrowFromRight(parent, i, level);
+  else if (i > 0)
+    merge(parent, i - 1, level);
+  else
+    merge(parent, i, level);
+}
+
+// Moves the last item or child of child i-1 to the front of child i.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::borrowFromLeft( Inner* parent, int i, int level ) {
+  int moved;
+  if (level == 0) {
+    Leaf* left = asLeaf(parent->children[i - 1]);
+    Leaf* t = asLeaf(parent->children[i]);
+    std::move_backward(t->items, t->items + t->count, t->items + t->count + 1);
+    t->items[0] = std::move(left->items[--left->count]);
+    left->items[left->count] = Comparable();
+    ++t->count;
+    parent->keys[i - 1] = t->items[0];
+    moved = 1;
+  } else {
+    Inner* left = asInner(parent->children[i - 1]);
+    Inner* t = asInner(parent->children[i]);
+    std::move_backward(t->keys, t->keys + t->count, t->keys + t->count + 1);
+    std::copy_backward(t->children, t->children + t->count + 1, t->children + t->count + 2);
+    std::copy_backward(t->sizes, t->sizes + t->count + 1, t->sizes + t->count + 2);
+    std::copy_backward(t->summaries, t->summaries + t->count + 1,
+                       t->summaries + t->count + 2);
+    t->keys[0] = std::move(parent->keys[i - 1]);
+    t->children[0] = left->children[left->count];
+    t->sizes[0] = moved = left->sizes[left->count];
+    t->summaries[0] = left->summaries[left->count];
+    ++t->count;
+    parent->keys[i - 1] = std::move(left->keys[--left->count]);
+    left->keys[left->count] = Comparable();
+  }
+  parent->sizes[i - 1] -= moved;
+  parent->sizes[i] += moved;
+  updateChild(parent, i - 1, level);
+  updateChild(parent, i, level);
+}
+
+// Moves the first item or child of child i+1 to the end of child i.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::borrowFromRight( Inner* parent, int i, int level ) {
+  int moved;
+  if (level == 0) {
+    Leaf* t = asLeaf(parent->children[i]);
+    Leaf* right = asLeaf(parent->children[i + 1]);
+    t->items[t->count++] = std::move(right->items[0]);
+    std::move(right->items + 1, right->items + right->count, right->items);
+    right->items[--right->count] = Comparable();
+    parent->keys[i] = right->items[0];
+    moved = 1;
+  } else {
+    Inner* t = asInner(parent->children[i]);
+    Inner* right = asInner(parent->children[i + 1]);
+    t->keys[t->count] = std::move(parent->keys[i]);
+    t->children[t->count + 1] = right->children[0];
+    t->sizes[t->count + 1] = moved = right->sizes[0];
+    t->summaries[t->count + 1] = right->summaries[0];
+    ++t->count;
+    parent->keys[i] = std::move(right->keys[0]);
+    std::move(right->keys + 1, right->keys + right->count, right->keys);
+    std::copy(right->children + 1, right->children + right->count + 1, right->children);
+    std::copy(right->sizes + 1, right->sizes + right->count + 1, right->sizes);
+    std::copy(right->summaries + 1, right->summaries + right->count + 1, right->summaries);
+    right->keys[--right->count] = Comparable();
+  }
+  parent->sizes[i] += moved;
+  parent->sizes[i + 1] -= moved;
+  updateChild(parent, i, level);
+  updateChild(parent, i + 1, level);
+}
+
+// Appends child i+1 to child i, frees it, and drops key i from parent.
+template <class Comparable, template <class> class NodePool, class Augment>
+void BPlusTree<Comparable, NodePool, Augment>::merge( Inner* parent, int i, int level ) {
+  if (level == 0) {
+    Leaf* t = asLeaf(parent->children[i]);
+    Leaf* right = asLeaf(parent->children[i + 1]);
+    std::move(right->items, right->items + right->count, t->items + t->count);
+    t->count += right->count;
+    t->next = right->next;
+    if (right->next != NULL)
+      right->next->prev = t;
+    leaves.destroy(right);
+  } else {
+    Inner* t = asInner(parent->children[i]);
+    Inner* right = asInner(parent->children[i + 1]);
+    t->keys[t->count] = std::move(parent->keys[i]);
+    std::move(right->keys, right->keys + right->count, t->keys + t->count + 1);
+    std::copy(right->children, right->children + right->count + 1, t->children + t->count + 1);
+    std::copy(right->sizes, right->sizes + right->count + 1, t->sizes + t->count + 1);
+    std::copy(right->summaries, right->summaries + right->count + 1,
+              t->summaries + t->count + 1);
+    t->count += right->count + 1;
+    inners.destroy(right);
+  }
+  parent->sizes[i] += parent->sizes[i + 1];
+  std::move(parent->keys + i + 1, parent->keys + parent->count, parent->keys + i);
+  std::copy(parent->children + i + 2, parent->children + parent->count + 1,
+            parent->children + i + 1);
+  std::copy(parent->sizes + i + 2, parent->sizes + parent->count + 1, parent->sizes + i + 1);
+  std::copy(parent->summaries + i + 2, parent->summaries + parent->count + 1,
+            parent->summaries + i + 1);
+  parent->keys[--parent->count] = Comparable();
+  updateChild(parent, i, level);
+}
+
+/** Replace the contents of the tree with the items in [first,last), which
+ *  must be sorted and contain no duplicates. The leaves are filled evenly
+ *  and the levels above built from them in linear time.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class RandomIt>
+void BPlusTree<Comparable, NodePool, Augment>::buildFromSorted( RandomIt first, RandomIt last ) {
+  makeEmpty();
+  const int n = static_cast<int>(last - first);
+  if (n == 0)
+    return;
+
+  // each level as its nodes, their sizes and summaries and the smallest
+  // item under each
+  std::vector<Node*> nodes;
+  std::vector<int> sizes;
+  std::vector<Summary> summaries;
+  std::vector<Comparable> smallest;
+
+  int count = (n + LEAF_ITEMS - 1) / LEAF_ITEMS;
+  Leaf* prev = NULL;
+  for ( int k = 0; k < count; ++k ) {
+    Leaf* leaf = leaves.create();
+    leaf->count = n / count + (k < n % count ? 1 : 0);
+    for ( int i = 0; i < leaf->count; ++i, ++first )
+      leaf->items[i] = *first;
+    leaf->prev = prev;
+    if (prev != NULL)
+      prev->next = leaf;
+    prev = leaf;
+    nodes.push_back(leaf);
+    sizes.push_back(leaf->count);
+    summaries.push_back(summaryOf(leaf, 0));
+    smallest.push_back(leaf->items[0]);
+  }
+
+  for ( levels = 0; nodes.size() > 1; ++levels ) {
+    const int m = static_cast<int>(nodes.size());
+    count = (m + INNER_KEYS) / (INNER_KEYS + 1);
+    std::vector<Node*> up;
+    std::vector<int> upSizes;
+    std::vector<Summary> upSummaries;
+    std::vector<Comparable> upSmallest;
+    for ( int k = 0, c = 0; k < count; ++k ) {
+      Inner* inner = inners.create();
+      int children = m / count + (k < m % count ? 1 : 0);
+      int size = 0;
+      upSmallest.push_back(std::move(smallest[c]));
+      for ( int j = 0; j < children; ++j, ++c ) {
+        if (j > 0)
+          inner->keys[j - 1] = std::move(smallest[c]);
+        inner->children[j] = nodes[c];
+        inner->sizes[j] = sizes[c];
+        inner->summaries[j] = summaries[c];
+        size += sizes[c];
+      }
+      inner->count = children - 1;
+      up.push_back(inner);
+      upSizes.push_back(size);
+      upSummaries.push_back(summaryOf(inner, levels + 1));
+    }
+    nodes.swap(up);
+    sizes.swap(upSizes);
+    summaries.swap(upSummaries);
+    smallest.swap(upSmallest);
+  }
+  root = nodes[0];
+  items = n;
+}
+
+/** Insert the items in [first,last), which must be sorted and contain no
+ *  duplicates. Items already in the tree are kept and the matching new ones
+ *  ignored, as insert does. The tree is rebuilt from the merged sequence in
+ *  linear time. Return the number of items added.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class RandomIt>
+int BPlusTree<Comparable, NodePool, Augment>::insertSorted( RandomIt first, RandomIt last ) {
+  if (isEmpty()) {
+    buildFromSorted(first, last);
+    return static_cast<int>(last - first);
+  }
+  std::vector<Comparable> merged;
+  int added = 0;
+  visitInOrder([&]( const Comparable& x ) {
+    for ( ; first != last && *first < x; ++first, ++added )
+      merged.push_back(*first);
+    if (first != last && !(x < *first))
+      ++first;    // duplicate; keep the old item
+    merged.push_back(x);
+  });
+  for ( ; first != last; ++first, ++added )
+    merged.push_back(*first);
+  buildFromSorted(std::make_move_iterator(merged.begin()),
+                  std::make_move_iterator(merged.end()));
+  return added;
+}
+
+/** Remove every item that satisfies p, rebuilding the tree from the rest
+ *  in linear time. Return the number of items removed.
+ */
+template <class Comparable, template <class> class NodePool, class Augment>
+template <class Predicate>
+int BPlusTree<Comparable, NodePool, Augment>::removeIf( const Predicate& p ) {
+  std::vector<Comparable> kept;
+  int removed = 0;
+  visitInOrder([&]( const Comparable& x ) {
+    if (p(x))
+      ++removed;
+    else
+      kept.push_back(x);
+  });
+  if (removed > 0)
+    buildFromSorted(std::make_move_iterator(kept.begin()),
+                    std::make_move_iterator(kept.end()));
+  return removed;
+}
+
+#endif /* _BPLUS_TREE_H_ */
@@ -0,0 +1,45 @@
+/*******************************************************************************
+  Title          : augment.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Subtree summaries for AvlTree and BPlusTree
+  Purpose        : To let a tree keep, in every subtree, a summary of the
+                   items under it, such as counts by category, so that a
+                   key range can be summarized in O(log n) without visiting
+                   its items.
+  Usage          : AvlTree<Tree, ArenaNodePool, BoroughCounts> trees( Tree() );
+  Build with     : -std=c++11
+*******************************************************************************/
+#ifndef _AUGMENT_H_
+#define _AUGMENT_H_
+
+/** An augmentation policy for a tree of Comparable items is a monoid:
+ *
+ *    value_type               the summary kept for each subtree; its default
+ *                             value is the summary of no items
+ *    value_type of( x )       the summary of the single item x
+ *    value_type combine( a, b )  the summary of the items summarized by a
+ *                             followed by those summarized by b; it must be
+ *                             associative, but need not be commutative or
+ *                             invertible
+ *
+ *  The tree recomputes a node's summary from its children's whenever the
+ *  node changes, so both functions should be cheap.
+ */
+
+/** struct NoAugment
+ *  The default policy, which summarizes nothing. Its summary is an empty
+ *  struct that the trees store in no space.
+ */
+struct NoAugment {
+  struct value_type { };
+
+  template <class Comparable>
+  static value_type of( const Comparable& ) { return value_type(); }
+
+  static value_type combine( const value_type&, const value_type& ) {
+    return value_type();
+  }
+};
+
+#endif /* _AUGMENT_H_ */
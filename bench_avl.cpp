@@ -0,0 +1,127 @@
+/*******************************************************************************
+  Title          : bench_avl.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Benchmark of the AvlTree node pools
+  Purpose        : Measures insert, bulk build, in-order traversal, countIf
+                   and destruction times of an AvlTree<Tree> whose nodes
+                   come from global new (HeapNodePool) and from slab blocks
+                   (ArenaNodePool). "count fn" passes countIf the kind of
+                   std::function<bool (Tree)> it used to take, which copies
+                   every tree it tests.
+  Usage          : bench_avl  [csv_file  [trees]]
+                   defaults to tests/trees10001.csv scaled up to 500000 trees
+  Build with     : make bench_avl
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <functional>
+#include <chrono>
+#include <cstdlib>
+
+#include "AvlTree.h"
+#include "tree.h"
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since( Clock::time_point start ) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report( const char* pool, const char* step, double seconds ) {
+  std::cout << std::left << std::setw(8) << pool << std::setw(12) << step
+            << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+            << seconds * 1000 << " ms\n";
+}
+
+template <template <class> class NodePool>
+void run( const char* name, const std::vector<Tree>& shuffled,
+          const std::vector<Tree>& sorted ) {
+  long sum = 0;
+  {
+    AvlTree<Tree, NodePool>* trees = new AvlTree<Tree, NodePool>( Tree() );
+    Clock::time_point start = Clock::now();
+    for ( const auto& t : shuffled )
+      trees->insert(t);
+    report(name, "insert", seconds_since(start));
+
+    start = Clock::now();
+    trees->visitInOrder([&sum](const Tree& t) { sum += t.id(); });
+    report(name, "traverse", seconds_since(start));
+
+    start = Clock::now();
+    int big = trees->countIf([](const Tree& t) { return t.diameter() > 20; });
+    report(name, "count", seconds_since(start));
+
+    std::function<bool (Tree)> by_value = [](Tree t) { return t.diameter() > 20; };
+    start = Clock::now();
+    if (trees->countIf(by_value) != big)
+      std::cout << name << ": counts disagree\n";
+    report(name, "count fn", seconds_since(start));
+
+    start = Clock::now();
+    delete trees;
+    report(name, "destroy", seconds_since(start));
+  }
+  {
+    AvlTree<Tree, NodePool>* trees = new AvlTree<Tree, NodePool>( Tree() );
+    Clock::time_point start = Clock::now();
+    trees->buildFromSorted(sorted.begin(), sorted.end());
+    report(name, "build", seconds_since(start));
+
+    start = Clock::now();
+    trees->visitInOrder([&sum](const Tree& t) { sum -= t.id(); });
+    report(name, "traverse", seconds_since(start));
+
+    start = Clock::now();
+    delete trees;
+    report(name, "destroy", seconds_since(start));
+  }
+  if (sum != 0)
+    std::cout << name << ": traversals disagree\n";
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  size_t count = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 500000;
+
+  std::ifstream in(path.c_str());
+  if (!in) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  std::vector<Tree> sample;
+  std::string line;
+  while (std::getline(in, line)) {
+    Tree t(line);
+    if (t.id() > 0)
+      sample.push_back(t);
+  }
+  if (sample.empty())
+    return 1;
+
+  // copies of the sample with fresh ids, so that every key is distinct
+  std::vector<Tree> trees;
+  trees.reserve(count);
+  for ( size_t i = 0; trees.size() < count; ++i ) {
+    const Tree& t = sample[i % sample.size()];
+    double lat, lon;
+    t.get_position(lat, lon);
+    trees.emplace_back(static_cast<int>(i + 1), t.diameter(), t.life_status(),
+                       t.tree_health(), t.common_name(), t.zip_code(),
+                       t.nearest_address(), t.borough_name(), lat, lon);
+  }
+  std::vector<Tree> sorted = trees;
+  std::sort(sorted.begin(), sorted.end());
+  std::shuffle(trees.begin(), trees.end(), std::mt19937(2019));
+
+  std::cout << trees.size() << " trees from " << path << "\n";
+  run<HeapNodePool>("heap", trees, sorted);
+  run<ArenaNodePool>("arena", trees, sorted);
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************
+  Title          : bench_bplus.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Benchmark of BPlusTree against AvlTree
+  Purpose        : Measures insert, point lookup, full scan by visitor and by
+                   iterator, bulk build and destruction of an ordered set of
+                   trees held in an AvlTree and in a BPlusTree, both with
+                   their nodes from an ArenaNodePool, and countIf by a
+                   haversine predicate against parallelCountIf on 2, 4 and
+                   8 threads.
+  Usage          : bench_bplus  [csv_file  [trees]]
+                   defaults to tests/trees10001.csv scaled up to 500000 trees
+  Build with     : make bench_bplus
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+#include "AvlTree.h"
+#include "BPlusTree.h"
+#include "haversine.h"
+#include "tree.h"
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since( Clock::time_point start ) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report( const char* container, const char* step, double seconds ) {
+  std::cout << std::left << std::setw(8) << container << std::setw(12) << step
+            << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+            << seconds * 1000 << " ms\n";
+}
+
+template <class Container>
+void run( const char* name, const std::vector<Tree>& shuffled,
+          const std::vector<Tree>& sorted ) {
+  long sum = 0;
+  {
+    Container* trees = new Container( Tree() );
+    Clock::time_point start = Clock::now();
+    for ( const auto& t : shuffled )
+      trees->insert(t);
+    report(name, "insert", seconds_since(start));
+
+    start = Clock::now();
+    long found = 0;
+    for ( const auto& t : shuffled )
+      found += trees->find(t).id() == t.id();
+    report(name, "find", seconds_since(start));
+    if (found != static_cast<long>(shuffled.size()))
+      std::cout << name << ": lost trees\n";
+
+    start = Clock::now();
+    trees->visitInOrder([&sum](const Tree& t) { sum += t.id(); });
+    report(name, "visit", seconds_since(start));
+
+    start = Clock::now();
+    long scanned = 0;
+    for ( const Tree& t : *trees )
+      scanned += t.id();
+    report(name, "iterate", seconds_since(start));
+    if (scanned != sum)
+      std::cout << name << ": visit and iterate disagree\n";
+
+    // a predicate no index serves, costly enough for the threads to pay
+    auto far = []( const Tree& t ) {
+      double lat, lon;
+      t.get_position(lat, lon);
+      return haversine(40.7128, -74.0060, lat, lon) > 10;
+    };
+    start = Clock::now();
+    int count = trees->countIf(far);
+    report(name, "count", seconds_since(start));
+    for ( unsigned threads : { 2u, 4u, 8u } ) {
+      start = Clock::now();
+      int parallel = trees->parallelCountIf(far, threads);
+      std::string step = "count " + std::to_string(threads) + "t";
+      report(name, step.c_str(), seconds_since(start));
+      if (parallel != count)
+        std::cout << name << ": parallel count disagrees\n";
+    }
+
+    start = Clock::now();
+    delete trees;
+    report(name, "destroy", seconds_since(start));
+  }
+  {
+    Container* trees = new Container( Tree() );
+    Clock::time_point start = Clock::now();
+    trees->buildFromSorted(sorted.begin(), sorted.end());
+    report(name, "build", seconds_since(start));
+
+    start = Clock::now();
+    trees->visitInOrder([&sum](const Tree& t) { sum -= t.id(); });
+    report(name, "visit", seconds_since(start));
+
+    delete trees;
+  }
+  if (sum != 0)
+    std::cout << name << ": traversals disagree\n";
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  size_t count = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 500000;
+
+  std::ifstream in(path.c_str());
+  if (!in) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  std::vector<Tree> sample;
+  std::string line;
+  while (std::getline(in, line)) {
+    Tree t(line);
+    if (t.id() > 0)
+      sample.push_back(t);
+  }
+  if (sample.empty())
+    return 1;
+
+  // copies of the sample with fresh ids, so that every key is distinct
+  std::vector<Tree> trees;
+  trees.reserve(count);
+  for ( size_t i = 0; trees.size() < count; ++i ) {
+    const Tree& t = sample[i % sample.size()];
+    double lat, lon;
+    t.get_position(lat, lon);
+    trees.emplace_back(static_cast<int>(i + 1), t.diameter(), t.life_status(),
+                       t.tree_health(), t.common_name(), t.zip_code(),
+                       t.nearest_address(), t.borough_name(), lat, lon);
+  }
+  std::vector<Tree> sorted = trees;
+  std::sort(sorted.begin(), sorted.end());
+  std::shuffle(trees.begin(), trees.end(), std::mt19937(2019));
+
+  std::cout << trees.size() << " trees from " << path << "\n";
+  run<AvlTree<Tree, ArenaNodePool> >("avl", trees, sorted);
+  run<BPlusTree<Tree, ArenaNodePool> >("b+tree", trees, sorted);
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+  Title          : bench_csv.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Benchmark of the csv delimiter scanners
+  Purpose        : Measures how many bytes per second each scanner splits
+                   into fields, on a census file repeated to a larger size.
+                   "scalar" is the byte-at-a-time loop the parser used before.
+  Usage          : bench_csv  [csv_file  [megabytes]]
+                   defaults to tests/trees10001.csv scaled up to 256 MB
+  Build with     : make bench_csv
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include "csv_scan.h"
+
+// splits every row of [first,last) into fields; returns the field count
+long count_fields( FieldSplitter split, const char* first, const char* last ) {
+  const int MAX_FIELDS = 64;
+  const char* ends[MAX_FIELDS];
+  long fields = 0;
+  while (first != last) {
+    const char* eol = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    if (eol == NULL)
+      eol = last;
+    fields += split(first, eol, ends, MAX_FIELDS);
+    first = eol == last ? last : eol + 1;
+  }
+  return fields;
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  size_t megabytes = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 256;
+
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  std::stringstream contents;
+  contents << in.rdbuf();
+  std::string sample = contents.str();
+  if (sample.empty())
+    return 1;
+  if (sample.back() != '\n')
+    sample += '\n';
+
+  std::string data;
+  data.reserve(megabytes << 20);
+  while (data.size() < (megabytes << 20))
+    data += sample;
+
+  const char* names[] = { "auto", "scalar", "sse2", "avx2" };
+  long expected = -1;
+
+  std::cout << "scanning " << data.size() / (1 << 20) << " MB of " << path << "\n";
+  for ( int kind = SCAN_SCALAR; kind <= SCAN_AVX2; ++kind ) {
+    FieldSplitter split = field_splitter(static_cast<ScanKind>(kind));
+    if (split == NULL) {
+      std::cout << std::left << std::setw(8) << names[kind] << "not supported\n";
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long fields = count_fields(split, data.data(), data.data() + data.size());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (expected < 0)
+      expected = fields;
+    std::cout << std::left << std::setw(8) << names[kind]
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << data.size() / elapsed.count() / (1 << 20) << " MB/s  "
+              << fields << " fields"
+              << (fields == expected ? "" : "  MISMATCH") << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************
+  Title          : bench_haversine.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Micro-benchmark of the haversine distance tests
+  Purpose        : Measures how many points per second are tested against a
+                   radius by haversine one pair at a time, by the batched
+                   kernel one point at a time, and by the batched kernel
+                   with AVX2, and checks that all three agree once the
+                   borderline points are decided by haversine.
+  Usage          : bench_haversine  [points  [radius_km]]
+                   defaults to 1000000 points spread over New York City
+                   and a radius of 1 km
+  Build with     : make bench_haversine
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+#include "haversine.h"
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since( Clock::time_point start ) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report( const char* method, size_t tests, double seconds, long near, long borderline ) {
+  std::cout << std::left << std::setw(12) << method
+            << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+            << tests / seconds / 1e6 << " M distances/s"
+            << std::setw(10) << near << " near"
+            << std::setw(8) << borderline << " borderline\n";
+}
+
+int main( int argc, char* argv[] ) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+  double radius = argc > 2 ? std::atof(argv[2]) : 1.0;
+  const int CENTRES = 20;
+
+  std::mt19937 random(2019);
+  std::uniform_real_distribution<double> lat_of(40.50, 40.91);
+  std::uniform_real_distribution<double> lon_of(-74.25, -73.70);
+  std::vector<double> lat(count), lon(count);
+  HaversinePoints points;
+  points.reserve(count);
+  for ( size_t i = 0; i < count; ++i ) {
+    lat[i] = lat_of(random);
+    lon[i] = lon_of(random);
+    points.push_back(lat[i], lon[i]);
+  }
+  std::vector<std::pair<double, double> > centres;
+  for ( int c = 0; c < CENTRES; ++c )
+    centres.emplace_back(lat_of(random), lon_of(random));
+  size_t tests = count * CENTRES;
+  std::cout << count << " points, " << CENTRES << " centres, "
+            << radius << " km\n";
+
+  Clock::time_point start = Clock::now();
+  long exact = 0;
+  for ( const auto& c : centres ) {
+    for ( size_t i = 0; i < count; ++i )
+      exact += haversine(c.first, c.second, lat[i], lon[i]) <= radius;
+  }
+  report("haversine", tests, seconds_since(start), exact, 0);
+
+  // the kernels' near points plus their borderline ones that haversine
+  // accepts must be exactly those haversine accepts
+  auto run = [&]( const char* method, bool simd ) {
+    std::vector<int> near, borderline;
+    long found = 0, undecided = 0, confirmed = 0;
+    Clock::time_point start = Clock::now();
+    for ( const auto& c : centres ) {
+      HaversineQuery q(c.first, c.second, radius);
+      near.clear();
+      borderline.clear();
+      if (simd)
+        haversine_select(points, 0, count, q, near, borderline);
+      else
+        haversine_select_scalar(points, 0, count, q, near, borderline);
+      found += near.size();
+      undecided += borderline.size();
+      for ( int k : borderline )
+        confirmed += haversine(c.first, c.second, lat[k], lon[k]) <= radius;
+    }
+    report(method, tests, seconds_since(start), found, undecided);
+    if (found + confirmed != exact)
+      std::cout << method << ": disagrees with haversine\n";
+  };
+  run("scalar", false);
+  if (haversine_simd())
+    run("avx2", true);
+  else
+    std::cout << "avx2        not available\n";
+  return 0;
+}
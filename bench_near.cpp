@@ -0,0 +1,95 @@
+/*******************************************************************************
+  Title          : bench_near.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Benchmark of get_all_near against a full scan
+  Purpose        : Measures the latency of radius queries answered from the
+                   TreeGrid by TreeCollection::get_all_near and by testing
+                   every tree with haversine, over radii from 25 m to 5 km,
+                   centred on trees of the census file.
+  Usage          : bench_near  [csv_file  [queries]]
+                   defaults to tests/trees10001.csv, 200 queries per radius
+  Build with     : make bench_near
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <list>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "haversine.h"
+#include "tree_collection.h"
+#include "tree_columns.h"
+#include "tree_loader.h"
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since( Clock::time_point start ) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// the names of the trees within distance of (lat,lon), in descending tree
+// order, found by testing every row of c
+std::list<std::string> scan_near( const TreeColumns& c, const std::vector<std::string>& names,
+                                  double lat, double lon, double distance ) {
+  std::list<std::string> result;
+  for ( size_t i = c.size(); i-- > 0; ) {
+    if (haversine(lat, lon, c.latitude[i], c.longitude[i]) <= distance)
+      result.push_back(names[i]);
+  }
+  return result;
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  size_t queries = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 200;
+
+  TreeCollection trees;
+  TreeLoader loader;
+  if (!loader.load(path, trees)) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  TreeColumns columns;
+  std::vector<std::string> names;
+  for ( const Tree& t : trees ) {
+    columns.push_back(t);
+    names.push_back(t.common_name());
+  }
+  if (columns.size() == 0 || queries == 0)
+    return 1;
+  std::cout << trees.total_tree_count() << " trees from " << path << "\n";
+
+  // the centres are trees spread evenly through the collection
+  std::vector<std::pair<double, double> > centres;
+  for ( size_t q = 0; q < queries; ++q ) {
+    size_t i = q * columns.size() / queries;
+    centres.emplace_back(columns.latitude[i], columns.longitude[i]);
+  }
+
+  const double radii[] = { 0.025, 0.1, 0.25, 0.5, 1, 2, 5 };
+  std::cout << std::setw(8) << "km" << std::setw(14) << "scan ms"
+            << std::setw(14) << "grid ms" << std::setw(12) << "results\n";
+  for ( double radius : radii ) {
+    long scanned = 0, found = 0;
+    Clock::time_point start = Clock::now();
+    for ( const auto& p : centres )
+      scanned += scan_near(columns, names, p.first, p.second, radius).size();
+    double scan_time = seconds_since(start);
+
+    start = Clock::now();
+    for ( const auto& p : centres )
+      found += trees.get_all_near(p.first, p.second, radius).size();
+    double grid_time = seconds_since(start);
+
+    if (found != scanned)
+      std::cout << "grid and scan disagree at " << radius << " km\n";
+    std::cout << std::setw(8) << std::fixed << std::setprecision(3) << radius
+              << std::setw(14) << scan_time * 1000 / queries
+              << std::setw(14) << grid_time * 1000 / queries
+              << std::setw(11) << found / static_cast<long>(queries) << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*******************************************************************************
+  Title          : bench_query.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Benchmark of the TreeCollection queries
+  Purpose        : Loads a census file and runs each query, reporting its
+                   time and how many heap allocations it made. Once the
+                   per-query setup is done, a query allocates only for the
+                   results it returns, however many trees it visits: a
+                   count makes at most a few allocations, and a list at
+                   most two per result, for its node and its string. A
+                   query over its budget is reported, and the exit status
+                   is then 1.
+  Usage          : bench_query  [csv_file  [repetitions  [threads]]]
+                   defaults to tests/trees10001.csv, 20 repetitions, 1 thread;
+                   threads is passed to TreeCollection::set_threads
+  Build with     : make bench_query, run by make check
+*******************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <list>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "tree_collection.h"
+#include "tree_loader.h"
+
+// every allocation made through global new is counted
+static long allocations = 0;
+
+void* operator new( std::size_t size ) {
+  ++allocations;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete( void* p ) noexcept {
+  std::free(p);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// allocations a query may make besides those per result, for its
+// working vectors and strings
+const long FIXED_ALLOCS = 64;
+
+static int over_budget = 0;
+
+// runs query repetitions times; reports the time and allocations per call
+// and the number of results of the last call, and whether the allocations
+// exceed FIXED_ALLOCS plus per_result for each result
+template <class Query>
+void measure( const char* name, int repetitions, long per_result, Query query ) {
+  query();    // not counted: it warms the caches
+  long before = allocations;
+  Clock::time_point start = Clock::now();
+  long results = 0;
+  for ( int i = 0; i < repetitions; ++i )
+    results = query();
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  long allocated = allocations - before;
+
+  std::cout << std::left << std::setw(24) << name
+            << std::right << std::setw(10) << std::fixed << std::setprecision(3)
+            << elapsed.count() * 1000 / repetitions << " ms"
+            << std::setw(10) << allocated / repetitions << " allocs"
+            << std::setw(10) << results << " results";
+  if (allocated / repetitions > FIXED_ALLOCS + per_result * results) {
+    std::cout << "  over budget";
+    ++over_budget;
+  }
+  std::cout << "\n";
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  int repetitions = argc > 2 ? std::atoi(argv[2]) : 20;
+  unsigned threads = argc > 3 ? std::strtoul(argv[3], NULL, 10) : 1;
+
+  TreeCollection trees;
+  TreeLoader loader;
+  if (!loader.load(path, trees)) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  trees.set_threads(threads);
+  std::cout << trees.total_tree_count() << " trees from " << path << "\n";
+
+  measure("count species", repetitions, 0, [&]() -> long {
+    return trees.count_of_tree_species("london planetree");
+  });
+  measure("count in boro", repetitions, 0, [&]() -> long {
+    return trees.count_of_trees_in_boro("Queens");
+  });
+  measure("count species in boro", repetitions, 0, [&]() -> long {
+    return trees.count_of_tree_species_in_boro("london planetree", "queens");
+  });
+  measure("counts by boro", repetitions, 0, [&]() -> long {
+    boro counts[5];
+    return trees.get_counts_of_trees_by_boro("oak", counts);
+  });
+  measure("matching species", repetitions, 2, [&]() -> long {
+    return trees.get_matching_species("maple").size();
+  });
+  measure("all in zipcode", repetitions, 2, [&]() -> long {
+    return trees.get_all_in_zipcode(10001).size();
+  });
+  measure("species in zipcode", repetitions, 2, [&]() -> long {
+    return trees.get_species_in_zipcode(10001).size();
+  });
+  measure("all near", repetitions, 2, [&]() -> long {
+    return trees.get_all_near(40.7515513, -73.99175365, 0.5).size();
+  });
+  measure("all near 5 km", repetitions, 2, [&]() -> long {
+    return trees.get_all_near(40.7515513, -73.99175365, 5).size();
+  });
+  return over_budget == 0 ? 0 : 1;
+}
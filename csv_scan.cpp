@@ -0,0 +1,152 @@
+/*******************************************************************************
+  Title          : csv_scan.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the csv delimiter scanner
+  Purpose        : To find the fields of a csv row 16 or 32 bytes at a time,
+                   using SSE2 or AVX2 when the processor supports them.
+  Usage          : 
+  Build with     : -std=c++11
+*******************************************************************************/
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CSV_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#include "csv_scan.h"
+
+namespace {
+
+// the byte-at-a-time loop, also used for the tail of the vector versions
+int split_tail( const char* p, const char* last, const char** ends,
+                int n, int max_fields, bool in_quotes ) {
+  for ( ; p != last; ++p ) {
+    if (*p == '"') {
+      in_quotes = !in_quotes;
+    } else if (*p == ',' && !in_quotes) {
+      ends[n++] = p;
+      if (n == max_fields)
+        return n;
+    }
+  }
+  ends[n++] = last;
+  return n;
+}
+
+int split_scalar( const char* first, const char* last, const char** ends, int max_fields ) {
+  if (max_fields <= 0)
+    return 0;
+  return split_tail(first, last, ends, 0, max_fields, false);
+}
+
+#ifdef CSV_SCAN_X86
+
+// Each block of bytes is turned into a bit mask of commas and one of quotes.
+// The prefix xor of the quote mask has bit i set when an odd number of quotes
+// occur at or before byte i, i.e. when byte i is inside quotes. A comma is
+// never a quote, so for commas "at or before" and "before" agree.
+inline uint32_t prefix_xor( uint32_t x ) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  return x;
+}
+
+// records the unquoted commas of one block of Width bytes at p; returns true
+// once max_fields ends have been stored
+template <int Width>
+inline bool match_block( const char* p, uint32_t commas, uint32_t quotes, 
+                         bool& in_quotes, const char** ends, int& n, int max_fields ) {
+  const uint32_t all = Width == 32 ? ~0u : (1u << Width) - 1;
+  uint32_t inside = prefix_xor(quotes) & all;
+  if (in_quotes)
+    inside ^= all;
+  in_quotes = ((inside >> (Width - 1)) & 1) != 0;
+
+  for ( uint32_t delims = commas & ~inside; delims != 0; delims &= delims - 1 ) {
+    ends[n++] = p + __builtin_ctz(delims);
+    if (n == max_fields)
+      return true;
+  }
+  return false;
+}
+
+int split_sse2( const char* first, const char* last, const char** ends, int max_fields ) {
+  if (max_fields <= 0)
+    return 0;
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i quote = _mm_set1_epi8('"');
+  bool in_quotes = false;
+  int n = 0;
+  const char* p = first;
+  for ( ; last - p >= 16; p += 16 ) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    uint32_t commas = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)));
+    uint32_t quotes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)));
+    if (match_block<16>(p, commas, quotes, in_quotes, ends, n, max_fields))
+      return n;
+  }
+  return split_tail(p, last, ends, n, max_fields, in_quotes);
+}
+
+__attribute__((target("avx2")))
+int split_avx2( const char* first, const char* last, const char** ends, int max_fields ) {
+  if (max_fields <= 0)
+    return 0;
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i quote = _mm256_set1_epi8('"');
+  bool in_quotes = false;
+  int n = 0;
+  const char* p = first;
+  for ( ; last - p >= 32; p += 32 ) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t commas = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, comma)));
+    uint32_t quotes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)));
+    if (match_block<32>(p, commas, quotes, in_quotes, ends, n, max_fields))
+      return n;
+  }
+  return split_tail(p, last, ends, n, max_fields, in_quotes);
+}
+
+#endif /* CSV_SCAN_X86 */
+
+FieldSplitter best_splitter() {
+#ifdef CSV_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return split_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return split_sse2;
+#endif
+  return split_scalar;
+}
+
+const FieldSplitter auto_splitter = best_splitter();
+
+} // namespace
+
+int split_fields( const char* first, const char* last, const char** ends, int max_fields ) {
+  return auto_splitter(first, last, ends, max_fields);
+}
+
+FieldSplitter field_splitter( ScanKind kind ) {
+  switch (kind) {
+    case SCAN_SCALAR:
+      return split_scalar;
+#ifdef CSV_SCAN_X86
+    case SCAN_SSE2:
+      return __builtin_cpu_supports("sse2") ? split_sse2 : NULL;
+    case SCAN_AVX2:
+      return __builtin_cpu_supports("avx2") ? split_avx2 : NULL;
+#endif
+    case SCAN_AUTO:
+      return auto_splitter;
+    default:
+      return NULL;
+  }
+}
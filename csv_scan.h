@@ -0,0 +1,45 @@
+/*******************************************************************************
+  Title          : csv_scan.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the csv delimiter scanner
+  Purpose        : To find the fields of a csv row 16 or 32 bytes at a time,
+                   using SSE2 or AVX2 when the processor supports them.
+  Usage          : 
+  Build with     : 
+*******************************************************************************/
+#ifndef _CSV_SCAN_H_
+#define _CSV_SCAN_H_
+
+/** The scanner implementations. SCAN_AUTO picks the widest one the
+ *  processor running the program supports.
+ */
+enum ScanKind {
+  SCAN_AUTO = 0,
+  SCAN_SCALAR,
+  SCAN_SSE2,
+  SCAN_AVX2
+};
+
+/** split_fields(first,last,ends,max_fields) locates the comma-separated 
+ *  fields of the csv row [first,last). A double quote toggles whether commas
+ *  count as delimiters for the rest of the row. The end of field i is stored
+ *  in ends[i]: the comma that closes it, or last for the final field. Fields
+ *  after the first max_fields are not scanned.
+ *  @param const char*  first      [in]  start of the row
+ *  @param const char*  last       [in]  end of the row, without the newline
+ *  @param const char** ends       [out] array of at least max_fields entries
+ *  @param int          max_fields [in]  the number of fields wanted
+ *  @return int  the number of fields found, at most max_fields
+ */
+int split_fields( const char* first, const char* last, const char** ends,
+                  int max_fields );
+
+typedef int (*FieldSplitter)( const char*, const char*, const char**, int );
+
+/** field_splitter(kind) returns the splitter of the given kind, or NULL if
+ *  the processor does not support it. split_fields uses SCAN_AUTO.
+ */
+FieldSplitter field_splitter( ScanKind kind );
+
+#endif /* _CSV_SCAN_H_ */
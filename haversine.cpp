@@ -0,0 +1,173 @@
+/*******************************************************************************
+  Title          : haversine.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Great-circle distances between trees
+  Purpose        : To compute the haversine distance of one pair of points,
+                   and to decide which of many points are within a distance
+                   of one point four at a time, without a trigonometric call
+                   per point.
+  Usage          :
+  Build with     : -std=c++11 -lm
+*******************************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL 1
+#endif
+
+#include "haversine.h"
+
+constexpr double R = 6372.8; //radius of the earth in km
+constexpr double TO_RAD = M_PI / 180.0; //conversion of degrees to rads
+
+constexpr double HaversineQuery::TOLERANCE;
+
+double haversine( double lat1, double lon1, double lat2, double lon2 ) {
+  lat1 = TO_RAD * lat1;
+  lat2 = TO_RAD * lat2;
+  lon1 = TO_RAD * lon1;
+  lon2 = TO_RAD * lon2;
+  double dLat = (lat2 - lat1)/2;
+  double dLon = (lon2 - lon1)/2;
+  double a = sin(dLat);
+  double b = sin(dLon);
+
+  return 2 * R * asin(sqrt(a*a + cos(lat1)*cos(lat2)*b*b));
+}
+
+// A point d km away differs from (lat,lon) by at most d/R radians of
+// latitude, and since the haversine formula gives at least
+// 2R asin(cos(lat) sin(dLon/2)) over the box's smallest cos(lat), by at most
+// 2 asin(sin(d/2R) / cos(lat)) of longitude.
+bool haversine_box( double lat, double lon, double d,
+                    double& lat_lo, double& lat_hi, double& lon_lo, double& lon_hi ) {
+  const double SLACK = 1e-9;    // for rounding in haversine
+  double dlat = d / R / TO_RAD + SLACK;
+  lat_lo = lat - dlat;
+  lat_hi = lat + dlat;
+  if (d >= M_PI * R || lat_lo <= -90 || lat_hi >= 90)
+    return false;
+  double min_cos = std::min(cos(TO_RAD * lat_lo), cos(TO_RAD * lat_hi));
+  double s = sin(d / (2 * R)) / min_cos;
+  if (s >= 1)
+    return false;
+  double dlon = 2 * asin(s) / TO_RAD + SLACK;
+  lon_lo = lon - dlon;
+  lon_hi = lon + dlon;
+  return lon_lo > -180 && lon_hi < 180;
+}
+
+void HaversinePoints::push_back( double lat, double lon ) {
+  lat = TO_RAD * lat;
+  lon = TO_RAD * lon;
+  sin_lat.push_back(sin(lat));
+  cos_lat.push_back(cos(lat));
+  sin_lon.push_back(sin(lon));
+  cos_lon.push_back(cos(lon));
+}
+
+void HaversinePoints::reserve( size_t points ) {
+  sin_lat.reserve(points);
+  cos_lat.reserve(points);
+  sin_lon.reserve(points);
+  cos_lon.reserve(points);
+}
+
+void HaversinePoints::clear() {
+  sin_lat.clear();
+  cos_lat.clear();
+  sin_lon.clear();
+  cos_lon.clear();
+}
+
+// h rises with the distance up to pi R, so the threshold on h is the
+// haversine of the largest angle within distance
+HaversineQuery::HaversineQuery( double lat, double lon, double distance ) {
+  lat = TO_RAD * lat;
+  lon = TO_RAD * lon;
+  sin_lat = sin(lat);
+  cos_lat = cos(lat);
+  sin_lon = sin(lon);
+  cos_lon = cos(lon);
+  double s = sin(std::min(distance / (2 * R), M_PI / 2));
+  below = s * s - TOLERANCE;
+  above = s * s + TOLERANCE;
+}
+
+void haversine_select_scalar( const HaversinePoints& p, int begin, int end,
+                              const HaversineQuery& q,
+                              std::vector<int>& near, std::vector<int>& borderline ) {
+  for ( int k = begin; k < end; ++k ) {
+    double cc = p.cos_lat[k] * q.cos_lat;
+    double lat_term = (1 - (cc + p.sin_lat[k] * q.sin_lat)) * 0.5;
+    double lon_term = (1 - (p.cos_lon[k] * q.cos_lon + p.sin_lon[k] * q.sin_lon)) * 0.5;
+    double h = lat_term + cc * lon_term;
+    if (h <= q.below)
+      near.push_back(k);
+    else if (!(h > q.above))    // NaN is borderline too
+      borderline.push_back(k);
+  }
+}
+
+#ifdef HAVE_AVX2_KERNEL
+// the scalar loop four points at a time, in the same order of operations
+__attribute__((target("avx2")))
+static void select_avx2( const HaversinePoints& p, int begin, int end,
+                         const HaversineQuery& q,
+                         std::vector<int>& near, std::vector<int>& borderline ) {
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d half = _mm256_set1_pd(0.5);
+  const __m256d q_sin_lat = _mm256_set1_pd(q.sin_lat);
+  const __m256d q_cos_lat = _mm256_set1_pd(q.cos_lat);
+  const __m256d q_sin_lon = _mm256_set1_pd(q.sin_lon);
+  const __m256d q_cos_lon = _mm256_set1_pd(q.cos_lon);
+  const __m256d below = _mm256_set1_pd(q.below);
+  const __m256d above = _mm256_set1_pd(q.above);
+
+  int k = begin;
+  for ( ; k + 4 <= end; k += 4 ) {
+    __m256d cc = _mm256_mul_pd(_mm256_loadu_pd(&p.cos_lat[k]), q_cos_lat);
+    __m256d lat_term = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_add_pd(cc,
+        _mm256_mul_pd(_mm256_loadu_pd(&p.sin_lat[k]), q_sin_lat))), half);
+    __m256d lon_term = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_add_pd(
+        _mm256_mul_pd(_mm256_loadu_pd(&p.cos_lon[k]), q_cos_lon),
+        _mm256_mul_pd(_mm256_loadu_pd(&p.sin_lon[k]), q_sin_lon))), half);
+    __m256d h = _mm256_add_pd(lat_term, _mm256_mul_pd(cc, lon_term));
+
+    int is_near = _mm256_movemask_pd(_mm256_cmp_pd(h, below, _CMP_LE_OQ));
+    int is_far = _mm256_movemask_pd(_mm256_cmp_pd(h, above, _CMP_GT_OQ));
+    if (is_far == 0xF)
+      continue;    // the common case of four far points
+    for ( int lane = 0; lane < 4; ++lane ) {
+      if (is_near & (1 << lane))
+        near.push_back(k + lane);
+      else if (!(is_far & (1 << lane)))
+        borderline.push_back(k + lane);
+    }
+  }
+  haversine_select_scalar(p, k, end, q, near, borderline);
+}
+#endif
+
+bool haversine_simd() {
+#ifdef HAVE_AVX2_KERNEL
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+#else
+  return false;
+#endif
+}
+
+void haversine_select( const HaversinePoints& p, int begin, int end, const HaversineQuery& q,
+                       std::vector<int>& near, std::vector<int>& borderline ) {
+#ifdef HAVE_AVX2_KERNEL
+  if (haversine_simd()) {
+    select_avx2(p, begin, end, q, near, borderline);
+    return;
+  }
+#endif
+  haversine_select_scalar(p, begin, end, q, near, borderline);
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+  Title          : haversine.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Great-circle distances between trees
+  Purpose        : To compute the haversine distance of one pair of points,
+                   and to decide which of many points are within a distance
+                   of one point four at a time, without a trigonometric call
+                   per point.
+  Usage          :
+  Build with     : -std=c++11
+*******************************************************************************/
+#ifndef _HAVERSINE_H_
+#define _HAVERSINE_H_
+
+#include <vector>
+#include <cstddef>
+
+/** haversine(lat1,lon1,lat2,lon2) returns the great-circle distance in km
+ *  between two points given in degrees
+ */
+double haversine( double lat1, double lon1, double lat2, double lon2 );
+
+/** haversine_box(lat,lon,d,lat_lo,lat_hi,lon_lo,lon_hi) sets the bounds of
+ *  a box of latitudes and longitudes holding every point within d km of
+ *  (lat,lon), as haversine measures it.
+ *  @return bool false if the box would wrap around a pole or the
+ *          antimeridian, when it bounds nothing
+ */
+bool haversine_box( double lat, double lon, double d,
+                    double& lat_lo, double& lat_hi, double& lon_lo, double& lon_hi );
+
+/** class HaversinePoints
+ *  The sines and cosines of the latitudes and longitudes of a sequence of
+ *  points, one contiguous array each, computed once when a point is added.
+ */
+class HaversinePoints {
+public:
+  std::vector<double> sin_lat;
+  std::vector<double> cos_lat;
+  std::vector<double> sin_lon;
+  std::vector<double> cos_lon;
+
+  /** push_back(lat,lon) appends the point (lat,lon), in degrees */
+  void push_back( double lat, double lon );
+
+  void reserve( size_t points );
+  void clear();
+  size_t size() const { return sin_lat.size(); }
+};
+
+/** struct HaversineQuery
+ *  A centre and distance prepared for haversine_select. With every sine and
+ *  cosine known, the haversine of the angle between the centre and a point,
+ *    h = (1 - cos dLat)/2 + cos lat1 cos lat2 (1 - cos dLon)/2,
+ *  takes only products and sums, since cos dLat = cos lat1 cos lat2 +
+ *  sin lat1 sin lat2, and likewise for dLon. The cancellation in 1 - cos
+ *  leaves an absolute error in h of a few units of 1e-16, so points whose
+ *  h is within TOLERANCE of the threshold are left to haversine itself.
+ */
+struct HaversineQuery {
+  HaversineQuery( double lat, double lon, double distance );
+
+  static constexpr double TOLERANCE = 1e-13;
+
+  double sin_lat, cos_lat, sin_lon, cos_lon;
+  double below;    // a point with h <= below is within the distance
+  double above;    // a point with h > above is not
+};
+
+/** haversine_select(p,begin,end,q,near,borderline) appends to near each
+ *  k in [begin,end) for which point k of p is certainly within q's distance
+ *  of its centre, and to borderline each k that haversine must decide. The
+ *  points are taken four at a time with AVX2 when the processor has it.
+ */
+void haversine_select( const HaversinePoints& p, int begin, int end, const HaversineQuery& q,
+                       std::vector<int>& near, std::vector<int>& borderline );
+
+/** haversine_select_scalar does the same one point at a time */
+void haversine_select_scalar( const HaversinePoints& p, int begin, int end,
+                              const HaversineQuery& q,
+                              std::vector<int>& near, std::vector<int>& borderline );
+
+/** haversine_simd() returns true if haversine_select uses AVX2 */
+bool haversine_simd();
+
+#endif /* _HAVERSINE_H_ */
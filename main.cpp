@@ -5,7 +5,12 @@
   Description    : The main program for Project1, processing NYC Tree Data
   Purpose        : reads the tree data file and a command file, applying
                    commands to the tree data.
-  Usage          : project1  datafile  commandfile
+  Usage          : project1  [-j threads]  [-w snapshot]  datafile  commandfile
+                   -j sets the number of threads used to parse the datafile
+                   and to run queries that scan every tree; 0 means one per
+                   core. The default is 1.
+                   -w saves the loaded trees to a binary snapshot file, 
+                   which can later be given as the datafile to skip parsing.
   Build with     : g++ -o project1 main.cpp tree.cpp tree_collection.cpp \
                         tree_species.cpp command.cpp utilities.cpp avl.cpp
   Modifications  : 
@@ -40,9 +45,12 @@
 #include <cstdlib>
 #include <errno.h>
 #include <limits.h>
+#include <unistd.h>
 
 #include "tree.h"
 #include "tree_collection.h"
+#include "tree_loader.h"
+#include "tree_snapshot.h"
 #include "command.cpp"
 
 using namespace std;
@@ -97,11 +105,10 @@ class comma_numpunct : public std::numpunct<char>
 int main( int argc, char* argv[])
 {
 
-    ifstream        inputfile;
     ifstream        commandfile;
     TreeCollection  NYCTrees;
-    string          tree_line;
-    Tree            temp_tree;
+    unsigned        num_threads = 1;
+    string          snapshot_file;
     list<string>    matching_species;
     string          input_string;
     boro  tree_counts_by_borough[5] = { {0,"Bronx"},
@@ -122,14 +129,27 @@ int main( int argc, char* argv[])
 	cerr << argv[i] <<endl;
     }
 */ 
-    if ( argc < 3 ) {
-        cerr << "\n Usage: " << argv[0] << " input_file  command_file" << endl;
-        exit(1);
+    int opt;
+    while ( (opt = getopt(argc, argv, "j:w:")) != -1 ) {
+        switch ( opt ) {
+            case 'j':
+                num_threads = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                snapshot_file = optarg;
+                break;
+            default:
+                cerr << "\n Usage: " << argv[0] 
+                     << " [-j threads] [-w snapshot] input_file  command_file" << endl;
+                exit(1);
+        }
     }
+    argc -= optind - 1;
+    argv += optind - 1;
 
-    inputfile.open(argv[1]);
-    if ( inputfile.fail() ) {
-        cerr << "Could not open data file " << argv[1] << " for reading" << endl;
+    if ( argc < 3 ) {
+        cerr << "\n Usage: " << argv[0] 
+             << " [-j threads] [-w snapshot] input_file  command_file" << endl;
         exit(1);
     }
 
@@ -139,22 +159,31 @@ int main( int argc, char* argv[])
         exit(1);
     }
 
+    if ( TreeSnapshot::is_snapshot(argv[1]) ) {
+        // A snapshot holds an already parsed and sorted collection
+        if ( ! TreeSnapshot::load(argv[1], NYCTrees) ) {
+            cerr << "Snapshot file " << argv[1] << " is damaged or of another version" << endl;
+            exit(1);
+        }
+    }
+    else {
+        // Map the data file and insert every tree it holds into the collection
+        TreeLoader loader(num_threads);
+        if ( ! loader.load(argv[1], NYCTrees) ) {
+            cerr << "Could not open data file " << argv[1] << " for reading" << endl;
+            exit(1);
+        }
+        if ( loader.bad_rows() > 0 )
+            cerr << "bad data: skipped " << loader.bad_rows() << " of " 
+                 << loader.rows_read() << " rows (" << loader.errors() << ")" << endl;
+    }
+
+    NYCTrees.set_threads(num_threads);
 
-    int count = 0;
-    int numtrees = 0;
-    while( getline(inputfile, tree_line) ) {
-       // Create a tree to insert into the TreeCollection
-            Tree  temp_tree(tree_line);
-            if ( 0 != temp_tree.id() ) {
-                numtrees += NYCTrees.add_tree(temp_tree);
-                count++;
-                }
-            else {
-                cerr << "bad data" << endl;
-            }
+    if ( ! snapshot_file.empty() && ! TreeSnapshot::save(NYCTrees, snapshot_file) ) {
+        cerr << "Could not write snapshot file " << snapshot_file << endl;
+        exit(1);
     }
-    
-    inputfile.close();
 
     // Create a locale to use that puts commas in long integers
     locale comma_locale(std::locale(), new comma_numpunct());
@@ -244,7 +273,7 @@ int main( int argc, char* argv[])
                 
             case remove_stumps_cmmd:
                 cout << "remove_stumps"  << endl;
-                
+                NYCTrees.remove_stumps();
                 break;
             case list_near_cmmd:
                 cout << "list_near "  << fixed << setprecision(6) << latitude << " " << longitude << " " << distance << endl;
@@ -275,27 +304,10 @@ int main( int argc, char* argv[])
             case listall_inzip_cmmd:
                 cout << "listall_inzip " << zipcode << endl;
                 cout.imbue(comma_locale);
-                matching_species = NYCTrees.get_all_in_zipcode(zipcode);      
-                it = matching_species.begin();
-                freq = 0;
-                prev = "";
-                while ( it != matching_species.end() ) {
-                    if ( prev == *it )
-                        freq++;
-                    else {
-                        if ( prev != "" ) 
-                            cout << "\t" 
-                                 << left << setw(22) << prev
-                                 << right << setw(8) << freq << endl;
-                        freq = 1;
-                        prev = *it;
-                    }
-                    it++;
-
-                }
-                if ( prev != "" ) 
-                    cout << "\t" << left << setw(22) << prev
-                         << right << setw(8) << freq << endl;
+                for ( const auto& species :
+                        NYCTrees.get_species_in_zipcode(zipcode) )
+                    cout << "\t" << left << setw(22) << species.first
+                         << right << setw(8) << species.second << endl;
                 cout.imbue(orig_locale);
                 break;
             case bad_cmmd:
@@ -0,0 +1,139 @@
+/*******************************************************************************
+  Title          : node_pool.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Node allocation policies for AvlTree
+  Purpose        : To let a tree choose between allocating each node with
+                   global new and carving its nodes out of large blocks.
+  Usage          : AvlTree<Tree, ArenaNodePool> trees( Tree() );
+  Build with     : -std=c++11
+*******************************************************************************/
+#ifndef _NODE_POOL_H_
+#define _NODE_POOL_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** A node pool policy for a tree of Node objects provides
+ *
+ *    Node* create( args... )  constructs a node from args
+ *    void  destroy( node )    destroys one node made by create
+ *    void  clear( )           destroys every node made by create
+ *    CLEARS_ALL               true if clear() does anything, so that the tree
+ *                             may call it instead of walking its nodes to
+ *                             destroy them one by one
+ *
+ *  A pool belongs to one tree and is never copied.
+ */
+
+/** class HeapNodePool
+ *  Allocates every node with global new and frees it with delete.
+ */
+template <class Node>
+class HeapNodePool {
+public:
+  static const bool CLEARS_ALL = false;
+
+  HeapNodePool() { }
+  HeapNodePool( const HeapNodePool& ) = delete;
+  HeapNodePool& operator=( const HeapNodePool& ) = delete;
+
+  template <class... Args>
+  Node* create( Args&&... args ) {
+    return new Node(std::forward<Args>(args)...);
+  }
+
+  void destroy( Node* node ) { delete node; }
+
+  void clear() { }
+};
+
+/** class ArenaNodePool
+ *  Allocates nodes BLOCK_NODES at a time in contiguous blocks, so that
+ *  nodes made one after the other sit next to each other in memory. A
+ *  destroyed node's slot is reused by the next create. clear() destroys the
+ *  live nodes block by block, in address order, and frees the blocks.
+ *  Only when Node has a trivial destructor does clear() skip the slots and
+ *  take time in the number of blocks; otherwise it visits every slot and
+ *  takes time in the number of nodes. It then saves only the pointer
+ *  chasing of a tree walk and the per-node deletes. A node holding a Tree,
+ *  whose address is a std::string, is of the second kind.
+ */
+template <class Node>
+class ArenaNodePool {
+public:
+  static const bool CLEARS_ALL = true;
+  enum { BLOCK_NODES = 4096 };
+
+  ArenaNodePool() : free_slots(NULL), used(BLOCK_NODES) { }
+  ArenaNodePool( const ArenaNodePool& ) = delete;
+  ArenaNodePool& operator=( const ArenaNodePool& ) = delete;
+  ~ArenaNodePool() { clear(); }
+
+  template <class... Args>
+  Node* create( Args&&... args ) {
+    Slot* slot = allocate();
+    Node* node = new (&slot->storage) Node(std::forward<Args>(args)...);
+    slot->next = live();
+    return node;
+  }
+
+  void destroy( Node* node ) {
+    node->~Node();
+    Slot* slot = reinterpret_cast<Slot*>(
+        reinterpret_cast<char*>(node) - offsetof(Slot, storage));
+    slot->next = free_slots;
+    free_slots = slot;
+  }
+
+  void clear() {
+    for ( size_t b = 0; b < blocks.size(); ++b ) {
+      if (!std::is_trivially_destructible<Node>::value) {
+        size_t n = b + 1 == blocks.size() ? used : BLOCK_NODES;
+        for ( size_t i = 0; i < n; ++i ) {
+          if (blocks[b][i].next == live())
+            reinterpret_cast<Node*>(&blocks[b][i].storage)->~Node();
+        }
+      }
+      delete [] blocks[b];
+    }
+    blocks.clear();
+    free_slots = NULL;
+    used = BLOCK_NODES;
+  }
+
+private:
+  // a node, or a link in the list of free slots
+  struct Slot {
+    Slot* next;    // live() while the slot holds a node
+    typename std::aligned_storage<sizeof(Node), alignof(Node)>::type storage;
+  };
+
+  std::vector<Slot*> blocks;
+  Slot* free_slots;
+  size_t used;     // slots handed out from the last block
+
+  // a marker that is not the address of any slot
+  static Slot* live() {
+    static char marker;
+    return reinterpret_cast<Slot*>(&marker);
+  }
+
+  Slot* allocate() {
+    if (free_slots != NULL) {
+      Slot* slot = free_slots;
+      free_slots = slot->next;
+      return slot;
+    }
+    if (used == BLOCK_NODES) {
+      blocks.push_back(new Slot[BLOCK_NODES]);
+      used = 0;
+    }
+    return &blocks.back()[used++];
+  }
+};
+
+#endif /* _NODE_POOL_H_ */
@@ -0,0 +1,159 @@
+/*******************************************************************************
+  Title          : parallel_for.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : A fork-join loop over independent tasks
+  Purpose        : To run the parts of a traversal or scan of a collection of
+                   trees on several threads, keeping the parts' results in
+                   order so that they can be combined as one sequential pass
+                   would have produced them.
+  Usage          : parallel_for(parts, items, num_threads, [&](size_t i) { ... });
+  Build with     : -std=c++11 -pthread
+*******************************************************************************/
+#ifndef _PARALLEL_FOR_H_
+#define _PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** The least number of items worth handing to other threads. Waking the
+ *  threads of the pool and waiting for them to finish costs more than
+ *  scanning a few thousand items.
+ */
+const size_t PARALLEL_CUTOFF = 16384;
+
+/** class TaskPool
+ *  Worker threads kept for the life of the program, so that a parallel
+ *  loop costs a wake-up instead of a thread start. Workers are started the
+ *  first time a loop asks for them. One loop runs on the pool at a time; a
+ *  loop that finds the pool busy, such as one started by a task of another
+ *  loop or by a concurrent query, runs on its calling thread alone.
+ */
+class TaskPool {
+public:
+  /** shared() returns the pool of the program */
+  static TaskPool& shared() {
+    static TaskPool pool;
+    return pool;
+  }
+
+  /** run(count,threads,task) calls task(i) once for every i in [0,count),
+   *  on the calling thread and up to threads - 1 workers, and returns when
+   *  all calls are done. Each thread takes the next i from a shared
+   *  counter, so one that finishes its part early goes on to the parts
+   *  still waiting instead of idling.
+   */
+  template <class Task>
+  void run( size_t count, size_t threads, const Task& task ) {
+    std::unique_lock<std::mutex> running(busy, std::try_to_lock);
+    if (!running.owns_lock()) {
+      for ( size_t i = 0; i < count; ++i )
+        task(i);
+      return;
+    }
+    while (workers.size() + 1 < threads)
+      workers.emplace_back(&TaskPool::serve, this);
+
+    std::function<void (size_t)> f = std::cref(task);
+    {
+      std::lock_guard<std::mutex> l(lock);
+      job = &f;
+      job_count = count;
+      next = 0;
+      seats = threads - 1;
+      joined = left = 0;
+      ++generation;
+    }
+    wake.notify_all();
+    work(f, count);
+
+    // workers not yet awake sit this loop out
+    std::unique_lock<std::mutex> l(lock);
+    seats = 0;
+    done.wait(l, [this]() { return left == joined; });
+    job = NULL;
+  }
+
+  ~TaskPool() {
+    {
+      std::lock_guard<std::mutex> l(lock);
+      stopping = true;
+    }
+    wake.notify_all();
+    for ( auto& w : workers )
+      w.join();
+  }
+
+private:
+  TaskPool() = default;
+  TaskPool( const TaskPool& ) = delete;
+  TaskPool& operator=( const TaskPool& ) = delete;
+
+  void work( const std::function<void (size_t)>& f, size_t count ) {
+    for ( size_t i = next++; i < count; i = next++ )
+      f(i);
+  }
+
+  // a worker joins each loop that has a seat left for it, at most once
+  void serve() {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> l(lock);
+    for ( ;; ) {
+      wake.wait(l, [&]() { return stopping || (generation != seen && seats > 0); });
+      if (stopping)
+        return;
+      seen = generation;
+      --seats;
+      ++joined;
+      const std::function<void (size_t)>& f = *job;
+      size_t count = job_count;
+      l.unlock();
+      work(f, count);
+      l.lock();
+      if (++left == joined)
+        done.notify_all();
+    }
+  }
+
+  std::mutex busy;                  // held by the loop running on the pool
+  std::vector<std::thread> workers;
+
+  std::mutex lock;                  // guards the fields below but next
+  std::condition_variable wake, done;
+  const std::function<void (size_t)>* job = NULL;
+  size_t job_count = 0;
+  std::atomic<size_t> next{0};
+  size_t seats = 0;                 // workers that may still join the loop
+  size_t joined = 0;                // workers that joined it
+  size_t left = 0;                  // and of those, the ones done
+  unsigned long generation = 0;     // loops started
+  bool stopping = false;
+};
+
+/** parallel_for(count,items,num_threads,task) calls task(i) once for every
+ *  i in [0,count) and returns when all calls are done; the calls together
+ *  handle items items. Up to num_threads threads of the shared TaskPool
+ *  take the parts as they come free; cutting the work into several parts
+ *  per thread keeps them all busy to the end. With one thread, one part or
+ *  fewer than PARALLEL_CUTOFF items, task runs on the calling thread.
+ */
+template <class Task>
+void parallel_for( size_t count, size_t items, unsigned num_threads, const Task& task ) {
+  size_t threads = std::min<size_t>(std::max(1u, num_threads), count);
+  if (items < PARALLEL_CUTOFF)
+    threads = 1;
+  if (threads <= 1) {
+    for ( size_t i = 0; i < count; ++i )
+      task(i);
+    return;
+  }
+  TaskPool::shared().run(count, threads, task);
+}
+
+#endif /* _PARALLEL_FOR_H_ */
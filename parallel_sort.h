@@ -0,0 +1,62 @@
+/*******************************************************************************
+  Title          : parallel_sort.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : A stable sort that runs on several threads
+  Purpose        : To sort large batches of parsed trees before they are
+                   bulk-loaded into a TreeCollection.
+  Usage          : parallel_stable_sort(v.begin(), v.end(), num_threads)
+  Build with     : -std=c++11 -pthread
+*******************************************************************************/
+#ifndef _PARALLEL_SORT_H_
+#define _PARALLEL_SORT_H_
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/** parallel_stable_sort(first,last,num_threads) sorts [first,last) with
+ *  operator<, keeping equal items in their original order. The range is cut
+ *  into num_threads chunks that are sorted concurrently, and neighbouring
+ *  chunks are then merged in rounds, each round also running concurrently.
+ */
+template <class RandomIt>
+void parallel_stable_sort( RandomIt first, RandomIt last, unsigned num_threads ) {
+  const size_t MIN_CHUNK = 4096;
+
+  size_t n = last - first;
+  size_t chunks = std::min<size_t>(std::max(1u, num_threads), n / MIN_CHUNK + 1);
+  if (chunks <= 1) {
+    std::stable_sort(first, last);
+    return;
+  }
+
+  std::vector<RandomIt> bounds;
+  for ( size_t i = 0; i <= chunks; ++i )
+    bounds.push_back(first + n * i / chunks);
+
+  std::vector<std::thread> workers;
+  for ( size_t i = 0; i < chunks; ++i )
+    workers.emplace_back([&bounds, i]() { std::stable_sort(bounds[i], bounds[i + 1]); });
+  for ( auto& w : workers )
+    w.join();
+
+  // merge pairs of neighbouring runs until one is left
+  while (bounds.size() > 2) {
+    std::vector<RandomIt> merged;
+    workers.clear();
+    for ( size_t i = 0; i + 1 < bounds.size(); i += 2 ) {
+      merged.push_back(bounds[i]);
+      if (i + 2 < bounds.size()) {
+        RandomIt a = bounds[i], b = bounds[i + 1], c = bounds[i + 2];
+        workers.emplace_back([a, b, c]() { std::inplace_merge(a, b, c); });
+      }
+    }
+    merged.push_back(bounds.back());
+    for ( auto& w : workers )
+      w.join();
+    bounds.swap(merged);
+  }
+}
+
+#endif /* _PARALLEL_SORT_H_ */
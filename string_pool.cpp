@@ -0,0 +1,82 @@
+/*******************************************************************************
+  Title          : string_pool.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the StringPool class
+  Purpose        : To store each distinct string of a small vocabulary once
+                   and refer to it by a small integer code.
+  Usage          : 
+  Build with     : -std=c++11
+*******************************************************************************/
+#include <cstring>
+#include <cctype>
+
+#include "string_pool.h"
+
+StringPool::StringPool() : slots(16, 0) { }
+
+// 32-bit FNV-1a
+uint32_t StringPool::hash( const char* first, const char* last ) {
+  uint32_t h = 2166136261u;
+  for ( ; first != last; ++first )
+    h = (h ^ static_cast<unsigned char>(*first)) * 16777619u;
+  return h;
+}
+
+// returns the slot holding [first,last), or the empty slot where it belongs
+size_t StringPool::slot_of( const char* first, const char* last, uint32_t h ) const {
+  size_t mask = slots.size() - 1;
+  size_t length = last - first;
+  for ( size_t i = h & mask; ; i = (i + 1) & mask ) {
+    int code = slots[i] - 1;
+    if (code < 0)
+      return i;
+    const std::string& s = names[code];
+    if (hashes[code] == h && s.size() == length 
+        && std::memcmp(s.data(), first, length) == 0)
+      return i;
+  }
+}
+
+// doubles the table, keeping it at most half full
+void StringPool::grow() {
+  std::vector<int> old(slots.size() * 2, 0);
+  slots.swap(old);
+  size_t mask = slots.size() - 1;
+  for ( int code = 0; code < size(); ++code ) {
+    size_t i = hashes[code] & mask;
+    while (slots[i] != 0)
+      i = (i + 1) & mask;
+    slots[i] = code + 1;
+  }
+}
+
+int StringPool::intern( const char* first, const char* last ) {
+  uint32_t h = hash(first, last);
+  size_t i = slot_of(first, last, h);
+  if (slots[i] != 0)
+    return slots[i] - 1;
+
+  int code = size();
+  names.emplace_back(first, last);
+  lowercased.push_back(names.back());
+  for ( auto& c : lowercased.back() )
+    c = std::tolower(c);
+  hashes.push_back(h);
+  slots[i] = code + 1;
+  if (2 * names.size() > slots.size())
+    grow();
+  return code;
+}
+
+int StringPool::intern( const std::string& s ) {
+  return intern(s.data(), s.data() + s.size());
+}
+
+int StringPool::find( const char* first, const char* last ) const {
+  return slots[slot_of(first, last, hash(first, last))] - 1;
+}
+
+int StringPool::find( const std::string& s ) const {
+  return find(s.data(), s.data() + s.size());
+}
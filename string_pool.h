@@ -0,0 +1,59 @@
+/*******************************************************************************
+  Title          : string_pool.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the StringPool class
+  Purpose        : To store each distinct string of a small vocabulary once
+                   and refer to it by a small integer code.
+  Usage          : 
+  Build with     : 
+*******************************************************************************/
+#ifndef _STRING_POOL_H_
+#define _STRING_POOL_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/** class StringPool
+ *  An interning table. Each distinct string added gets the next code,
+ *  starting at 0, and codes never change. Equal codes from the same pool
+ *  mean equal strings. Lookups work directly on a character range, so
+ *  interning a string that is already present allocates nothing.
+ */
+class StringPool {
+public:
+  static const int NOT_FOUND = -1;
+
+  StringPool();
+
+  /** intern(first,last) returns the code of [first,last), adding it if new */
+  int intern( const char* first, const char* last );
+  int intern( const std::string& s );
+
+  /** find(s) returns the code of s, or NOT_FOUND if it was never added */
+  int find( const char* first, const char* last ) const;
+  int find( const std::string& s ) const;
+
+  /** name(code) returns the string with the given code */
+  const std::string& name( int code ) const { return names[code]; }
+
+  /** lowercase(code) returns name(code) in lowercase, computed when the
+   *  string was added
+   */
+  const std::string& lowercase( int code ) const { return lowercased[code]; }
+
+  int size() const { return static_cast<int>(names.size()); }
+
+private:
+  static uint32_t hash( const char* first, const char* last );
+  size_t slot_of( const char* first, const char* last, uint32_t h ) const;
+  void grow();
+
+  std::vector<std::string> names;   // indexed by code
+  std::vector<std::string> lowercased; // indexed by code
+  std::vector<uint32_t> hashes;     // indexed by code
+  std::vector<int> slots;           // open addressing table of code + 1
+};
+
+#endif /* _STRING_POOL_H_ */
@@ -0,0 +1,300 @@
+/*******************************************************************************
+  Title          : test_collection.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Tests of the TreeCollection queries
+  Purpose        : Checks that the queries that scan many trees give the
+                   same results on several threads as on one, on a
+                   collection large enough for them to split the work,
+                   and when several of them run at once right after a
+                   change that leaves their columns to be rebuilt. Checks
+                   the borough counts of every species name against a
+                   count of the matching trees, before and after a new
+                   species that the names match is added, and the species
+                   borough and zipcode counts against counts taken from the
+                   trees themselves after add_tree, remove_tree and
+                   remove_stumps.
+                   Prints each failure and exits with status 1 if any.
+  Usage          : test_collection  [csv_file]
+                   defaults to tests/trees10001.csv
+  Build with     : make check
+*******************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <cctype>
+
+#include "parallel_for.h"
+#include "tree_collection.h"
+#include "tree_species.h"
+
+static int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+  if (!ok) {
+    std::cout << "FAIL: " << what << "\n";
+    ++failures;
+  }
+}
+
+// get_counts_of_trees_by_boro of the name of every species of trees, as
+// counted by matching every tree
+void check_counts_by_name( TreeCollection& trees, const std::string& when ) {
+  std::vector<std::string> names;
+  for ( const Tree& t : trees ) {
+    if (names.empty() || names.back() != t.common_name())
+      names.push_back(t.common_name());
+  }
+  for ( const std::string& name : names ) {
+    int expected[BORO_COUNT] = { 0 };
+    int expected_total = 0;
+    for ( const Tree& t : trees ) {
+      if (is_matching_species(t.common_name(), name)) {
+        ++expected[t.boro_code()];
+        ++expected_total;
+      }
+    }
+    boro counts[BORO_COUNT];
+    bool same = trees.get_counts_of_trees_by_boro(name, counts) == expected_total;
+    for ( int b = BRONX; b < BORO_COUNT; ++b )
+      same = same && counts[b].count == expected[b];
+    check(same, "get_counts_of_trees_by_boro(\"" + name + "\") " + when);
+  }
+}
+
+std::string lowercase( const std::string& s ) {
+  std::string l;
+  for ( char c : s )
+    l += std::tolower(static_cast<unsigned char>(c));
+  return l;
+}
+
+// the counts that the collection keeps up to date, against the same
+// counts taken from its trees
+void check_indexes( TreeCollection& trees, const std::string& when ) {
+  // spellings that differ only in case are one species
+  std::map<std::string, int> species;
+  for ( const Tree& t : trees )
+    ++species[lowercase(t.common_name())];
+  for ( const Tree& t : trees ) {
+    const std::string& name = t.common_name();
+    check(trees.count_of_tree_species(name) == species[lowercase(name)],
+          "count_of_tree_species(\"" + name + "\") " + when);
+  }
+  check(trees.count_of_tree_species("no such species") == 0,
+        "count_of_tree_species of a missing species " + when);
+
+  // the species x borough matrix and the borough totals
+  std::map<std::pair<std::string, int>, int> in_boro;
+  int boro_total[BORO_COUNT] = { 0 };
+  int total = 0;
+  for ( const Tree& t : trees ) {
+    ++in_boro[std::make_pair(lowercase(t.common_name()), static_cast<int>(t.boro_code()))];
+    ++boro_total[t.boro_code()];
+    ++total;
+  }
+  for ( int b = BRONX; b < BORO_COUNT; ++b ) {
+    const std::string& boro_name = name_of(static_cast<Borough>(b));
+    check(trees.count_of_trees_in_boro(boro_name) == boro_total[b],
+          "count_of_trees_in_boro(\"" + boro_name + "\") " + when);
+    for ( const Tree& t : trees ) {
+      const std::string& name = t.common_name();
+      check(trees.count_of_tree_species_in_boro(name, boro_name)
+              == in_boro[std::make_pair(lowercase(name), b)],
+            "count_of_tree_species_in_boro(\"" + name + "\", \"" + boro_name + "\") " + when);
+    }
+  }
+  check(trees.total_tree_count() == total, "total_tree_count " + when);
+
+  // the species histogram of each zipcode: the species in descending tree
+  // order, and within a species its spellings in any order
+  typedef std::vector<std::pair<std::string, int> > Spellings;
+  std::map<int, std::vector<Spellings> > zip_species;
+  std::vector<const Tree*> descending;
+  for ( const Tree& t : trees )
+    descending.push_back(&t);
+  std::reverse(descending.begin(), descending.end());
+  for ( const Tree* t : descending ) {
+    std::vector<Spellings>& species_list = zip_species[t->zip_code()];
+    if (species_list.empty() ||
+        lowercase(species_list.back().front().first) != lowercase(t->common_name()))
+      species_list.push_back(Spellings());
+    Spellings& spellings = species_list.back();
+    auto entry = std::find_if(spellings.begin(), spellings.end(),
+        [t]( const std::pair<std::string, int>& e ) { return e.first == t->common_name(); });
+    if (entry == spellings.end())
+      spellings.emplace_back(t->common_name(), 1);
+    else
+      ++entry->second;
+  }
+  zip_species[0];    // a zipcode with no trees
+  for ( auto& zip : zip_species ) {
+    std::vector<Spellings> found;
+    for ( const auto& e : trees.get_species_in_zipcode(zip.first) ) {
+      if (found.empty() || lowercase(found.back().front().first) != lowercase(e.first))
+        found.push_back(Spellings());
+      found.back().push_back(e);
+    }
+    for ( auto* species_list : { &zip.second, &found } ) {
+      for ( Spellings& spellings : *species_list )
+        std::sort(spellings.begin(), spellings.end());
+    }
+    check(found == zip.second,
+          "get_species_in_zipcode(" + std::to_string(zip.first) + ") " + when);
+  }
+}
+
+// a copy of t with another id, species, zipcode and status
+Tree variant( const Tree& t, int id, const std::string& name, int zipcode,
+              const std::string& status ) {
+  double lat, lon;
+  t.get_position(lat, lon);
+  return Tree(id, t.diameter(), status, t.tree_health(), name, zipcode,
+              t.nearest_address(), t.borough_name(), lat, lon);
+}
+
+// the collection of the sample, checked by check_indexes after each kind
+// of change
+void check_indexes_after_changes( const std::vector<Tree>& sample ) {
+  TreeCollection trees;
+  std::vector<Tree> copy = sample;
+  trees.add_trees(copy);
+  check_indexes(trees, "after loading");
+
+  // another spelling of a species, a new species, a species in a new
+  // zipcode, and stumps of each
+  int id = 1000000000;
+  std::vector<Tree> added;
+  for ( size_t i = 0; i < sample.size(); i += sample.size() / 8 + 1 ) {
+    const Tree& t = sample[i];
+    std::string upper = t.common_name();
+    if (!upper.empty())
+      upper[0] = std::toupper(static_cast<unsigned char>(upper[0]));
+    for ( const std::string& status : { std::string("Alive"), std::string("Stump") } ) {
+      added.push_back(variant(t, ++id, upper, t.zip_code(), status));
+      added.push_back(variant(t, ++id, "test species", 10001, status));
+      added.push_back(variant(t, ++id, t.common_name(), 99999, status));
+    }
+  }
+  for ( Tree& t : added )
+    check(trees.add_tree(t) == 1, "add_tree of a new tree");
+  check_indexes(trees, "after add_tree");
+
+  std::vector<Tree> removed;
+  int i = 0;
+  for ( const Tree& t : trees ) {
+    if (i++ % 7 == 0)
+      removed.push_back(t);
+  }
+  for ( const Tree& t : removed )
+    check(trees.remove_tree(t) == 1, "remove_tree of a tree in the collection");
+  check_indexes(trees, "after remove_tree");
+
+  int stumps = 0;
+  for ( const Tree& t : trees )
+    stumps += lowercase(t.life_status()) == "stump";
+  check(stumps > 0 && trees.remove_stumps() == stumps, "remove_stumps removes every stump");
+  check_indexes(trees, "after remove_stumps");
+}
+
+int main( int argc, char* argv[] ) {
+  std::string path = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  std::ifstream in(path.c_str());
+  if (!in) {
+    std::cerr << "Could not open " << path << " for reading" << std::endl;
+    return 1;
+  }
+  std::vector<Tree> sample;
+  std::string line;
+  while (std::getline(in, line)) {
+    Tree t(line);
+    if (t.id() > 0)
+      sample.push_back(t);
+  }
+  if (sample.empty())
+    return 1;
+
+  check_indexes_after_changes(sample);
+
+  {
+    TreeCollection small;
+    std::vector<Tree> copy = sample;
+    small.add_trees(copy);
+    check_counts_by_name(small, "after loading");
+    double lat, lon;
+    sample.front().get_position(lat, lon);
+    Tree longer(1, 10, "Alive", "Good", "northern " + sample.front().common_name(),
+                10001, "", "Queens", lat, lon);
+    small.add_tree(longer);
+    check_counts_by_name(small, "after adding a species with a longer name");
+  }
+
+  // copies of the sample with fresh ids, enough for several slices of
+  // PARALLEL_CUTOFF rows
+  const size_t COUNT = 8 * PARALLEL_CUTOFF;
+  std::vector<Tree> batch;
+  for ( size_t i = 0; batch.size() < COUNT; ++i ) {
+    const Tree& t = sample[i % sample.size()];
+    double lat, lon;
+    t.get_position(lat, lon);
+    batch.emplace_back(static_cast<int>(i + 1), t.diameter(), t.life_status(),
+                       t.tree_health(), t.common_name(), t.zip_code(),
+                       t.nearest_address(), t.borough_name(), lat, lon);
+  }
+  TreeCollection trees;
+  check(trees.add_trees(batch) == static_cast<int>(COUNT), "every tree is added");
+
+  const int zipcodes[] = { 10001, 10463, 11375, 99999 };
+  const double radii[] = { 0.025, 0.5, 5, 50 };
+  for ( unsigned threads : { 2u, 4u } ) {
+    std::string with = " on " + std::to_string(threads) + " threads";
+    for ( int zipcode : zipcodes ) {
+      trees.set_threads(1);
+      std::list<std::string> serial = trees.get_all_in_zipcode(zipcode);
+      trees.set_threads(threads);
+      check(trees.get_all_in_zipcode(zipcode) == serial,
+            "get_all_in_zipcode(" + std::to_string(zipcode) + ")" + with);
+    }
+    for ( double radius : radii ) {
+      trees.set_threads(1);
+      std::list<std::string> serial = trees.get_all_near(40.7515513, -73.99175365, radius);
+      trees.set_threads(threads);
+      check(trees.get_all_near(40.7515513, -73.99175365, radius) == serial,
+            "get_all_near(" + std::to_string(radius) + " km)" + with);
+    }
+  }
+
+  // add_tree leaves the columns stale; concurrent queries must rebuild
+  // them once and all see the added tree
+  Tree extra = batch.front();
+  double lat, lon;
+  extra.get_position(lat, lon);
+  Tree added(static_cast<int>(COUNT + 1), extra.diameter(), extra.life_status(),
+             extra.tree_health(), extra.common_name(), extra.zip_code(),
+             extra.nearest_address(), extra.borough_name(), lat, lon);
+  trees.set_threads(1);
+  trees.add_tree(added);
+  std::vector<std::list<std::string> > seen(4);
+  std::vector<std::thread> queries;
+  for ( size_t q = 0; q < seen.size(); ++q )
+    queries.emplace_back([&trees, &seen, q, lat, lon]() {
+      seen[q] = trees.get_all_near(lat, lon, 0.025);
+    });
+  for ( auto& q : queries )
+    q.join();
+  std::list<std::string> expected = trees.get_all_near(lat, lon, 0.025);
+  for ( const auto& s : seen )
+    check(s == expected, "get_all_near right after add_tree, on 4 threads at once");
+  trees.remove_tree(added);
+  check(trees.get_all_near(lat, lon, 0.025).size() + 1 == expected.size(),
+        "get_all_near right after remove_tree");
+
+  if (failures == 0)
+    std::cout << "test_collection: all passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+/*******************************************************************************
+  Title          : test_containers.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Tests of AvlTree and BPlusTree against std::set
+  Purpose        : Runs random inserts, removals, removeIf, insertSorted and
+                   buildFromSorted on each container and on a std::set of
+                   the same keys, in phases that grow and shrink the tree,
+                   and after every change checks the
+                   contents, forward and reverse iteration, find, rank,
+                   select, countRange, lower_bound, upper_bound, countIf,
+                   collectIntoListIf, summary and summarizeRange against the
+                   set, and the height against the bound of the container
+                   and, for AvlTree, the AVL condition at every node.
+                   Checks the parallel scans of a large tree against the
+                   sequential ones.
+                   A B+tree of items of a kilobyte has four items a leaf,
+                   so that it splits, borrows and merges nodes all the time.
+                   Prints each failure and exits with status 1 if any.
+  Usage          : test_containers  [rounds]
+                   defaults to 4000 changes per container
+  Build with     : make check
+*******************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+#include "AvlTree.h"
+#include "BPlusTree.h"
+
+static int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+  if (!ok) {
+    std::cout << "FAIL: " << what << "\n";
+    ++failures;
+  }
+}
+
+const int NOT_FOUND = -1;    // keys are never negative
+
+// an item of a kilobyte, which leaves room for four in a B+tree leaf
+struct Wide {
+  int key;
+  char pad[1020];
+
+  Wide( int k = NOT_FOUND ) : key(k) { }
+  bool operator<( const Wide& rhs ) const { return key < rhs.key; }
+};
+
+int key_of( int x ) { return x; }
+int key_of( const Wide& x ) { return x.key; }
+
+/** struct Span
+ *  An augmentation that keeps the first and last key, the number and the
+ *  sum of the keys of a range. It is not commutative, so a summary combined
+ *  out of order is caught.
+ */
+struct Span {
+  struct value_type {
+    int first = NOT_FOUND, last = NOT_FOUND, count = 0;
+    long sum = 0;
+
+    bool operator==( const value_type& rhs ) const {
+      return first == rhs.first && last == rhs.last && count == rhs.count && sum == rhs.sum;
+    }
+  };
+
+  template <class Comparable>
+  static value_type of( const Comparable& x ) {
+    value_type s;
+    s.first = s.last = key_of(x);
+    s.count = 1;
+    s.sum = key_of(x);
+    return s;
+  }
+
+  static value_type combine( const value_type& a, const value_type& b ) {
+    if (a.count == 0)
+      return b;
+    if (b.count == 0)
+      return a;
+    value_type s;
+    s.first = a.first;
+    s.last = b.last;
+    s.count = a.count + b.count;
+    s.sum = a.sum + b.sum;
+    return s;
+  }
+};
+
+Span::value_type span_of( const std::set<int>& model, int lo, int hi ) {
+  Span::value_type s;
+  for ( auto k = model.lower_bound(lo); k != model.end() && *k <= hi; ++k )
+    s = Span::combine(s, Span::of(*k));
+  return s;
+}
+
+// the most levels an AVL tree of n items can have
+bool avl_height_ok( int height, int n ) {
+  return height < 1.4405 * std::log2(n + 2.0) - 0.3277;
+}
+
+// the most levels a B+tree of n items can have when its leaves hold at
+// least MIN_ITEMS items and its inner nodes but the root at least
+// MIN_KEYS + 1 children
+template <class Container>
+bool bplus_height_ok( int height, int n ) {
+  if (height <= 0)
+    return true;
+  double least = 2.0 * Container::MIN_ITEMS;
+  for ( int level = 1; level < height; ++level )
+    least *= Container::MIN_KEYS + 1;
+  return n >= least;
+}
+
+template <class Container>
+bool height_ok( const Container& c, int n );
+
+template <class Comparable, template <class> class NodePool, class Augment>
+bool height_ok( const AvlTree<Comparable, NodePool, Augment>& c, int n ) {
+  return c.isBalanced() && avl_height_ok(c.height(), n);
+}
+
+template <class Comparable, template <class> class NodePool, class Augment>
+bool height_ok( const BPlusTree<Comparable, NodePool, Augment>& c, int n ) {
+  return bplus_height_ok<BPlusTree<Comparable, NodePool, Augment> >(c.height(), n);
+}
+
+// c against model, by every query, probing with keys drawn by random
+template <class Container>
+void check_queries( const Container& c, const std::set<int>& model,
+                    std::mt19937& random, int max_key, const std::string& where ) {
+  typedef typename Container::const_iterator::value_type Item;
+  std::uniform_int_distribution<int> key(0, max_key + 1);
+  int n = static_cast<int>(model.size());
+
+  check(c.size() == n && c.isEmpty() == (n == 0), where + ": size");
+  check(height_ok(c, n), where + ": balanced, height " + std::to_string(c.height()) +
+        " within the bound for " + std::to_string(n) + " items");
+
+  std::vector<int> forward, backward, visited;
+  for ( const Item& x : c )
+    forward.push_back(key_of(x));
+  for ( auto x = c.rbegin(); x != c.rend(); ++x )
+    backward.push_back(key_of(*x));
+  c.visitInOrder([&visited]( const Item& x ) { visited.push_back(key_of(x)); });
+  std::vector<int> expected(model.begin(), model.end());
+  check(forward == expected, where + ": forward iteration");
+  check(visited == expected, where + ": visitInOrder");
+  std::reverse(expected.begin(), expected.end());
+  check(backward == expected, where + ": reverse iteration");
+  if (n > 0) {
+    check(key_of(c.findMin()) == *model.begin() && key_of(c.findMax()) == *model.rbegin(),
+          where + ": findMin, findMax");
+  }
+
+  check(c.summary() == span_of(model, 0, max_key + 1), where + ": summary");
+  for ( int probe = 0; probe < 8; ++probe ) {
+    int x = key(random);
+    std::string at = where + " at " + std::to_string(x);
+    check(key_of(c.find(Item(x))) == (model.count(x) ? x : NOT_FOUND), at + ": find");
+    int rank = static_cast<int>(std::distance(model.begin(), model.lower_bound(x)));
+    check(c.rank(Item(x)) == rank, at + ": rank");
+
+    auto lower = c.lower_bound(Item(x));
+    auto model_lower = model.lower_bound(x);
+    check(model_lower == model.end() ? lower == c.end()
+                                     : lower != c.end() && key_of(*lower) == *model_lower,
+          at + ": lower_bound");
+    auto upper = c.upper_bound(Item(x));
+    auto model_upper = model.upper_bound(x);
+    check(model_upper == model.end() ? upper == c.end()
+                                     : upper != c.end() && key_of(*upper) == *model_upper,
+          at + ": upper_bound");
+    if (model_lower != model.begin()) {
+      --lower;
+      check(key_of(*lower) == *std::prev(model_lower), at + ": -- from lower_bound");
+    }
+
+    int k = std::uniform_int_distribution<int>(-1, n)(random);
+    int selected = k >= 0 && k < n ? *std::next(model.begin(), k) : NOT_FOUND;
+    check(key_of(c.select(k)) == selected, at + ": select(" + std::to_string(k) + ")");
+
+    int y = key(random);
+    int lo = std::min(x, y), hi = std::max(x, y);
+    int in_range = static_cast<int>(std::distance(model.lower_bound(lo), model.upper_bound(hi)));
+    check(c.countRange(Item(lo), Item(hi)) == in_range, at + ": countRange");
+    check(c.summarizeRange(Item(lo), Item(hi)) == span_of(model, lo, hi), at + ": summarizeRange");
+    std::vector<int> range;
+    c.visitRange(Item(lo), Item(hi), [&range]( const Item& i ) { range.push_back(key_of(i)); });
+    check(range == std::vector<int>(model.lower_bound(lo), model.upper_bound(hi)),
+          at + ": visitRange");
+  }
+
+  int m = std::uniform_int_distribution<int>(2, 7)(random);
+  auto multiple = [m]( const Item& x ) { return key_of(x) % m == 0; };
+  std::list<int> collected;
+  for ( const Item& x : c.collectIntoListIf(multiple) )
+    collected.push_back(key_of(x));
+  std::list<int> expected_list;
+  for ( auto k = model.rbegin(); k != model.rend(); ++k ) {
+    if (*k % m == 0)
+      expected_list.push_back(*k);
+  }
+  check(c.countIf(multiple) == static_cast<int>(expected_list.size()), where + ": countIf");
+  check(collected == expected_list, where + ": collectIntoListIf, largest first");
+}
+
+// random changes to a Container and a std::set side by side
+template <class Container>
+void run( const std::string& name, int rounds, int max_key ) {
+  typedef typename Container::const_iterator::value_type Item;
+  std::mt19937 random(2019);
+  std::uniform_int_distribution<int> key(0, max_key);
+  std::uniform_int_distribution<int> action(0, 199);
+  Container c((Item(NOT_FOUND)));
+  std::set<int> model;
+
+  for ( int round = 0; round < rounds; ++round ) {
+    std::string where = name + " round " + std::to_string(round);
+    // phases of mostly inserts and of mostly removals, so that whole
+    // levels of nodes fill up and then drain again
+    bool growing = round / 500 % 2 == 0;
+    int a = action(random);
+    if (a < (growing ? 140 : 50)) {
+      int x = key(random);
+      check(c.insert(Item(x)) == (model.insert(x).second ? 1 : 0), where + ": insert");
+    } else if (a < 196) {
+      // removals mostly of keys that are present
+      int x = model.empty() || a % 4 == 0 ? key(random)
+            : *std::next(model.begin(), std::uniform_int_distribution<int>(
+                  0, static_cast<int>(model.size()) - 1)(random));
+      check(c.remove(Item(x)) == static_cast<int>(model.erase(x)), where + ": remove");
+    } else if (a < 198) {
+      int m = std::uniform_int_distribution<int>(2, 5)(random);
+      int removed = 0;
+      for ( auto k = model.begin(); k != model.end(); )
+        k = *k % m == 0 ? (++removed, model.erase(k)) : std::next(k);
+      int result = c.removeIf([m]( const Item& x ) { return key_of(x) % m == 0; });
+      check(result == removed, where + ": removeIf");
+    } else if (a < 199) {
+      std::set<int> batch_keys;
+      for ( int i = std::uniform_int_distribution<int>(0, 300)(random); i > 0; --i )
+        batch_keys.insert(key(random));
+      std::vector<Item> batch(batch_keys.begin(), batch_keys.end());
+      int added = 0;
+      for ( int k : batch_keys )
+        added += model.insert(k).second;
+      check(c.insertSorted(batch.begin(), batch.end()) == added, where + ": insertSorted");
+    } else {
+      std::set<int> batch_keys;
+      for ( int i = std::uniform_int_distribution<int>(0, 500)(random); i > 0; --i )
+        batch_keys.insert(key(random));
+      std::vector<Item> batch(batch_keys.begin(), batch_keys.end());
+      c.buildFromSorted(batch.begin(), batch.end());
+      model = batch_keys;
+    }
+    check_queries(c, model, random, max_key, where);
+    if (failures > 20)
+      return;
+  }
+
+  Container copy(c);
+  std::vector<int> copied;
+  for ( const Item& x : copy )
+    copied.push_back(key_of(x));
+  check(copied == std::vector<int>(model.begin(), model.end()), name + ": copy");
+  c.makeEmpty();
+  check(c.isEmpty() && c.size() == 0 && c.begin() == c.end(), name + ": makeEmpty");
+}
+
+// parallelCountIf and parallelCollectIntoListIf against countIf and
+// collectIntoListIf, on a tree large enough to be split, on several
+// numbers of threads and with two scans at once, so that one of them
+// finds the TaskPool busy
+template <class Container>
+void check_parallel( const std::string& name ) {
+  typedef typename Container::const_iterator::value_type Item;
+  std::mt19937 random(2020);
+  std::vector<Item> sorted;
+  for ( int k = 0; k < 200000; k += 2 )
+    sorted.push_back(Item(k));
+  Container c((Item(NOT_FOUND)));
+  c.buildFromSorted(sorted.begin(), sorted.end());
+  std::uniform_int_distribution<int> key(0, 200000);
+  for ( int k = 0; k < 30000; ++k ) {
+    c.insert(Item(key(random)));
+    c.remove(Item(key(random)));
+  }
+
+  for ( int m : { 1, 3, 1000, 1000000 } ) {
+    auto multiple = [m]( const Item& x ) { return key_of(x) % m == 0; };
+    int count = c.countIf(multiple);
+    std::list<Item> collected = c.collectIntoListIf(multiple);
+    for ( unsigned threads : { 1u, 2u, 3u, 4u, 8u } ) {
+      std::string what = name + " on " + std::to_string(threads) + " threads, multiples of " +
+                         std::to_string(m);
+      check(c.parallelCountIf(multiple, threads) == count, what + ": parallelCountIf");
+      std::list<Item> parallel = c.parallelCollectIntoListIf(multiple, threads);
+      check(parallel.size() == collected.size() &&
+            std::equal(parallel.begin(), parallel.end(), collected.begin(),
+                       []( const Item& a, const Item& b ) { return key_of(a) == key_of(b); }),
+            what + ": parallelCollectIntoListIf");
+    }
+    int other = 0;
+    std::thread concurrent([&]() { other = c.parallelCountIf(multiple, 4); });
+    int mine = c.parallelCountIf(multiple, 4);
+    concurrent.join();
+    check(mine == count && other == count,
+          name + ": two parallelCountIf at once, multiples of " + std::to_string(m));
+  }
+}
+
+int main( int argc, char* argv[] ) {
+  int rounds = argc > 1 ? std::atoi(argv[1]) : 4000;
+
+  run<AvlTree<int, HeapNodePool, Span> >("avl", rounds, 2000);
+  run<AvlTree<int, ArenaNodePool, Span> >("avl arena", rounds, 2000);
+  run<BPlusTree<int, ArenaNodePool, Span> >("b+tree", rounds, 20000);
+  run<BPlusTree<Wide, HeapNodePool, Span> >("b+tree 4 a leaf", rounds, 2000);
+  run<BPlusTree<Wide, ArenaNodePool, Span> >("b+tree 4 a leaf arena", rounds, 300);
+  check_parallel<AvlTree<int, ArenaNodePool, Span> >("avl");
+  check_parallel<BPlusTree<int, ArenaNodePool, Span> >("b+tree");
+
+  if (failures == 0)
+    std::cout << "test_containers: all passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*******************************************************************************
+  Title          : test_near.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Tests of get_all_near and of haversine_select
+  Purpose        : Checks get_all_near, which reads only the grid cells
+                   near its centre and tests their trees with the batched
+                   haversine kernel, against a scan of every tree with
+                   haversine itself. The trees stand on the corners and
+                   edges of the 250 m cells, on the edges of the grid and
+                   outside it, and at random; the distances include the
+                   exact distance of a tree and the doubles either side of
+                   it, which fall in the band the kernel leaves to
+                   haversine. Checks haversine_select and
+                   haversine_select_scalar against haversine on the same
+                   points.
+                   Prints each failure and exits with status 1 if any.
+  Usage          : test_near
+  Build with     : make check
+*******************************************************************************/
+#include <iostream>
+#include <string>
+#include <list>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "haversine.h"
+#include "tree_collection.h"
+
+static int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+  if (!ok) {
+    std::cout << "FAIL: " << what << "\n";
+    ++failures;
+  }
+}
+
+// the grid of tree_grid.h
+const double LAT_MIN = 40.45, LAT_MAX = 40.95, LON_MIN = -74.30, LON_MAX = -73.65;
+const double LAT_STEP = 0.00225, LON_STEP = 0.003;
+
+struct Point {
+  double lat, lon;
+};
+
+// the corners and edge midpoints of the cells around (40.7,-73.95), the
+// corners of the grid and points just inside and outside its edges, and
+// points at random over and around the city
+std::vector<Point> test_points( std::mt19937& random ) {
+  std::vector<Point> points;
+  int band = static_cast<int>((40.7 - LAT_MIN) / LAT_STEP);
+  int column = static_cast<int>((-73.95 - LON_MIN) / LON_STEP);
+  for ( int i = band - 6; i <= band + 6; ++i ) {
+    for ( int j = column - 6; j <= column + 6; ++j ) {
+      double lat = LAT_MIN + i * LAT_STEP, lon = LON_MIN + j * LON_STEP;
+      points.push_back({lat, lon});
+      points.push_back({lat + LAT_STEP / 2, lon});
+      points.push_back({lat, lon + LON_STEP / 2});
+    }
+  }
+  for ( double lat : { LAT_MIN, LAT_MAX } ) {
+    for ( double lon : { LON_MIN, LON_MAX } ) {
+      for ( double d : { -1e-9, 0.0, 1e-9 } ) {
+        points.push_back({lat + d, lon});
+        points.push_back({lat, lon + d});
+      }
+    }
+  }
+  std::uniform_real_distribution<double> lat(LAT_MIN - 0.05, LAT_MAX + 0.05);
+  std::uniform_real_distribution<double> lon(LON_MIN - 0.05, LON_MAX + 0.05);
+  for ( int k = 0; k < 3000; ++k )
+    points.push_back({lat(random), lon(random)});
+  return points;
+}
+
+// the species of the trees within d km of (lat,lon), by a scan of every
+// tree, in the descending order of get_all_near
+std::list<std::string> all_near( const std::vector<Tree>& descending,
+                                 double lat, double lon, double d ) {
+  std::list<std::string> result;
+  for ( const Tree& t : descending ) {
+    double tree_lat, tree_lon;
+    t.get_position(tree_lat, tree_lon);
+    if (haversine(lat, lon, tree_lat, tree_lon) <= d)
+      result.push_back(t.common_name());
+  }
+  return result;
+}
+
+// haversine_select and haversine_select_scalar against haversine, for the
+// points within d of point c; returns the number of borderline points
+int check_select( const HaversinePoints& trig, const std::vector<Point>& points,
+                  const Point& c, double d, const std::string& what ) {
+  HaversineQuery q(c.lat, c.lon, d);
+  std::vector<int> near, borderline, near_scalar, borderline_scalar;
+  int n = static_cast<int>(points.size());
+  haversine_select(trig, 0, n, q, near, borderline);
+  haversine_select_scalar(trig, 0, n, q, near_scalar, borderline_scalar);
+  check(near == near_scalar && borderline == borderline_scalar,
+        what + ": haversine_select agrees with haversine_select_scalar");
+
+  std::vector<char> certain(n, 0);
+  for ( int k : near )
+    certain[k] = 1;
+  for ( int k : borderline )
+    certain[k] = 2;
+  int wrong = 0;
+  for ( int k = 0; k < n; ++k ) {
+    bool within = haversine(c.lat, c.lon, points[k].lat, points[k].lon) <= d;
+    if ((certain[k] == 1 && !within) || (certain[k] == 0 && within))
+      ++wrong;
+  }
+  check(wrong == 0, what + ": haversine_select decides as haversine does, " +
+        std::to_string(wrong) + " points wrong");
+  return static_cast<int>(borderline.size());
+}
+
+int main() {
+  std::mt19937 random(2024);
+  std::vector<Point> points = test_points(random);
+
+  // each tree its own species, so that the lists name the trees
+  std::vector<Tree> trees;
+  HaversinePoints trig;
+  for ( size_t k = 0; k < points.size(); ++k ) {
+    trees.push_back(Tree(static_cast<int>(k + 1), 10, "Alive", "Good",
+                         "species " + std::to_string(k), 10001, "1 test street",
+                         "Manhattan", points[k].lat, points[k].lon));
+    trig.push_back(points[k].lat, points[k].lon);
+  }
+  std::vector<Tree> descending = trees;
+  std::sort(descending.begin(), descending.end());
+  std::reverse(descending.begin(), descending.end());
+  TreeCollection collection;
+  collection.add_trees(trees);
+
+  // the centres are trees, so that a radius of exactly the distance to
+  // another tree puts that tree on the boundary
+  std::uniform_int_distribution<int> any(0, static_cast<int>(points.size()) - 1);
+  int borderline = 0;
+  for ( int query = 0; query < 120; ++query ) {
+    // the first centres stand on cell corners and edges
+    const Point& c = points[query < 60 ? query * 3 : any(random)];
+    const Point& other = points[any(random)];
+    double exact = haversine(c.lat, c.lon, other.lat, other.lon);
+    double inf = std::numeric_limits<double>::infinity();
+    for ( double d : { exact, std::nextafter(exact, 0.0), std::nextafter(exact, inf),
+                       0.0, 0.125, 0.25, 1.0 } ) {
+      std::string what = "get_all_near(" + std::to_string(c.lat) + "," +
+                         std::to_string(c.lon) + "," + std::to_string(d) + ")";
+      check(collection.get_all_near(c.lat, c.lon, d) == all_near(descending, c.lat, c.lon, d),
+            what + " matches a scan of every tree");
+      borderline += check_select(trig, points, c, d, what);
+    }
+  }
+  check(borderline > 0, "some points fall in the band left to haversine");
+
+  if (failures == 0)
+    std::cout << "test_near: all passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*******************************************************************************
+  Title          : test_snapshot.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Tests of the tree snapshot files
+  Purpose        : Checks that a saved snapshot loads back to the same
+                   collection, that save replaces a file whole or not at
+                   all, and that snapshots with damaged or crafted headers
+                   are rejected without reading outside the file.
+                   Prints each failure and exits with status 1 if any.
+  Usage          : test_snapshot  [csv_file]
+                   defaults to tests/trees10001.csv
+  Build with     : make check
+*******************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include "tree_collection.h"
+#include "tree_loader.h"
+#include "tree_snapshot.h"
+
+static int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+  if (!ok) {
+    std::cout << "FAIL: " << what << "\n";
+    ++failures;
+  }
+}
+
+std::string printed( const TreeCollection& trees ) {
+  std::ostringstream out;
+  trees.print(out);
+  return out.str();
+}
+
+std::string read_file( const std::string& path ) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  std::ostringstream bytes;
+  bytes << in.rdbuf();
+  return bytes.str();
+}
+
+void write_file( const std::string& path, const std::string& bytes ) {
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(bytes.data(), bytes.size());
+}
+
+// the header fields at their offsets in the file
+const size_t TREE_COUNT = 16, STRING_COUNT = 20, STRING_BYTES = 24;
+
+template <class T>
+T field( const std::string& bytes, size_t offset ) {
+  T value;
+  std::memcpy(&value, bytes.data() + offset, sizeof value);
+  return value;
+}
+
+template <class T>
+void set_field( std::string& bytes, size_t offset, T value ) {
+  std::memcpy(&bytes[offset], &value, sizeof value);
+}
+
+// loads the snapshot bytes into a new collection; it must be rejected and
+// leave the collection empty
+void check_rejected( const std::string& bytes, const std::string& path,
+                     const std::string& what ) {
+  write_file(path, bytes);
+  TreeCollection trees;
+  check(!TreeSnapshot::load(path, trees) && trees.total_tree_count() == 0,
+        what + " is rejected");
+}
+
+int main( int argc, char* argv[] ) {
+  std::string csv = argc > 1 ? argv[1] : "tests/trees10001.csv";
+  const std::string path = "test_snapshot.snap";
+
+  TreeCollection trees;
+  TreeLoader loader;
+  if (!loader.load(csv, trees)) {
+    std::cerr << "Could not open " << csv << " for reading" << std::endl;
+    return 1;
+  }
+
+  write_file(path, "an older file, longer than the header of a snapshot ...");
+  check(TreeSnapshot::save(trees, path), "save writes the snapshot");
+  check(std::ifstream((path + ".tmp").c_str()).fail(), "save leaves no temporary file");
+  TreeCollection loaded;
+  check(TreeSnapshot::load(path, loaded), "the saved snapshot loads");
+  check(printed(loaded) == printed(trees), "the snapshot loads back to the same trees");
+  check(!TreeSnapshot::save(trees, "no_such_directory/test_snapshot.snap"),
+        "save into a missing directory fails");
+
+  const std::string good = read_file(path);
+  check_rejected(good.substr(0, good.size() - 1), path, "a truncated snapshot");
+  check_rejected(good.substr(0, 20), path, "a snapshot cut inside its header");
+
+  // each of these keeps the payload size of the Layout, and so passes the
+  // size and checksum tests, by wrapping string_bytes around 2^64
+  std::string more_strings = good;
+  uint32_t k = 1u << 30;
+  set_field<uint32_t>(more_strings, STRING_COUNT,
+                      field<uint32_t>(good, STRING_COUNT) + k);
+  set_field<uint64_t>(more_strings, STRING_BYTES,
+                      field<uint64_t>(good, STRING_BYTES) - 4ull * k);
+  check_rejected(more_strings, path, "a string count beyond the file");
+
+  std::string more_trees = good;
+  uint32_t t = 1u << 24;
+  set_field<uint32_t>(more_trees, TREE_COUNT, field<uint32_t>(good, TREE_COUNT) + t);
+  set_field<uint64_t>(more_trees, STRING_BYTES,
+                      field<uint64_t>(good, STRING_BYTES) - 48ull * t);
+  check_rejected(more_trees, path, "a tree count beyond the file");
+
+  std::string flipped = good;
+  flipped[flipped.size() / 2] ^= 1;
+  check_rejected(flipped, path, "a snapshot with a changed byte");
+
+  std::remove(path.c_str());
+  if (failures == 0)
+    std::cout << "test_snapshot: all passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+  Title          : test_tree.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : Tests of the Tree row parser
+  Purpose        : Checks that the numeric fields of a row are read as strtod
+                   reads them, whichever path of parse_double they take, and
+                   that a row with a bad numeric field makes an empty tree,
+                   and that species codes past 16 bits stay distinct.
+                   Prints each failure and exits with status 1 if any.
+  Usage          : test_tree
+  Build with     : make check
+*******************************************************************************/
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+#include "tree.h"
+
+static int failures = 0;
+
+void check( bool ok, const std::string& what ) {
+  if (!ok) {
+    std::cout << "FAIL: " << what << "\n";
+    ++failures;
+  }
+}
+
+// a row of the census file with its latitude field replaced by latitude
+std::string row_with_latitude( const std::string& latitude ) {
+  return "182258,104487,08/28/2015,4,0,OnCurb,Alive,Good,Styphnolobium japonicum,"
+         "Sophora,1or2,Helpful,Damage,Volunteer,WiresRope,No,No,No,Yes,No,No,No,"
+         "No,No,151 WEST 28 STREET,10001,New York,105,1,Manhattan,3,75,27,MN17,"
+         "Midtown-Midtown South,1009500,New York," + latitude +
+         ",-73.99280743,986242.9543,211446.7356";
+}
+
+void check_latitude( const std::string& field ) {
+  std::string line = row_with_latitude(field);
+  TreeParseErrors errors;
+  Tree t(line.data(), line.data() + line.size(), &errors);
+  double expected = std::strtod(field.c_str(), NULL);
+  double lat, lon;
+  t.get_position(lat, lon);
+  bool same = lat == expected || (std::isnan(lat) && std::isnan(expected));
+  check(t.id() == 182258 && errors.total() == 0 && same,
+        "latitude \"" + field + "\" is read as strtod reads it");
+}
+
+int main() {
+  const char* latitudes[] = {
+    "40.74704876", "-73.99280743", "+40.5", "  40.5", "40", "0.000001",
+    "0x1A", "0X1a", "-0x10", "4.074704876e1", "1E-3",
+    "40.7470487612345678901234", "123456789012345678901", "inf", "nan",
+    "12abc"
+  };
+  for ( const char* latitude : latitudes )
+    check_latitude(latitude);
+
+  std::string bad = row_with_latitude("north");
+  TreeParseErrors errors;
+  Tree t(bad.data(), bad.data() + bad.size(), &errors);
+  check(t.id() == 0 && errors.count[TreeParseErrors::LATITUDE] == 1,
+        "a latitude with no number makes an empty tree and is counted");
+
+  // the first and the 65537th species of one set of dictionaries; their
+  // codes differ only above the low 16 bits
+  TreeDictionaries dicts;
+  Tree first(1, 10, "Alive", "Good", "species 0", 10001, "", "Manhattan", 40.7, -74.0, &dicts);
+  for ( int i = 1; i < 65536; ++i )
+    dicts.species.intern("species " + std::to_string(i));
+  Tree last(1, 10, "Alive", "Good", "species 65536", 10001, "", "Manhattan", 40.7, -74.0, &dicts);
+  check(last.species_code() == 65536 && last.common_name() == "species 65536",
+        "a species code past 65535 names its own species");
+  check(!(first == last) && (first < last || last < first),
+        "trees of species whose codes agree in their low 16 bits differ");
+
+  if (failures == 0)
+    std::cout << "test_tree: all passed\n";
+  return failures == 0 ? 0 : 1;
+}
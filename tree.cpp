@@ -14,67 +14,399 @@
 *******************************************************************************/
 
 #include <iostream>
-#include <vector>
 #include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <climits>
 
 #include "tree.h"
+#include "csv_scan.h"
 
-typedef std::vector<std::string> string_array;
+namespace {
 
-//TODO: function should ignore delimiters between certain characters '\'
-string_array split( std::string s, char delimiter = ',', size_t size = 0) {
-  string_array string_vector;
-  if (size > 0) {
-    string_vector.reserve(size);
+// Gives the comma-separated fields of one csv row without copying them.
+// A double quote toggles whether commas count as delimiters for the rest of
+// the row, and the quotes themselves stay part of the field. The delimiters
+// of the first max_fields fields are located in one pass by the vectorized
+// splitter in csv_scan.cpp.
+class FieldCursor {
+public:
+  enum { MAX_FIELDS = 64 };
+
+  FieldCursor( const char* first, const char* last, int max_fields )
+    : begin_of_next(first), index(0) {
+    count = split_fields(first, last, ends, std::min<int>(max_fields, MAX_FIELDS));
+  }
+
+  // sets [begin,end) to the next field; returns false past the last field
+  bool next( const char*& begin, const char*& end ) {
+    if (index >= count) return false;
+    begin = begin_of_next;
+    end = ends[index++];
+    begin_of_next = end + 1;
+    return true;
+  }
+
+  // moves past the next n fields; returns false if the row runs out first
+  bool skip( int n ) {
+    if (n <= 0) return true;
+    if (index + n > count) return false;
+    index += n;
+    begin_of_next = ends[index - 1] + 1;
+    return true;
+  }
+
+private:
+  const char* ends[MAX_FIELDS];
+  const char* begin_of_next;
+  int count;
+  int index;
+};
+
+struct FieldSpan {
+  const char* begin;
+  const char* end;
+};
+
+// The columns of the census file that a Tree keeps, in file order. They
+// are the only fields the parser copies; the others are skipped over and
+// parsing stops after the last of them.
+enum Column {
+  TREE_ID_COLUMN    = 0,
+  TREE_DBH_COLUMN   = 3,
+  STATUS_COLUMN     = 6,
+  HEALTH_COLUMN     = 7,
+  SPC_COMMON_COLUMN = 9,
+  ADDRESS_COLUMN    = 24,
+  ZIPCODE_COLUMN    = 25,
+  BORONAME_COLUMN   = 29,
+  LATITUDE_COLUMN   = 37,
+  LONGITUDE_COLUMN  = 38
+};
+
+// Extractor<-1, c1, c2, ...>::run(fields, spans) stores the spans of the
+// columns c1 < c2 < ... into spans[0], spans[1], ... The column list is
+// unrolled at compile time into a fixed sequence of skips and reads.
+template <int Prev, int... Cols>
+struct Extractor;
+
+template <int Prev>
+struct Extractor<Prev> {
+  static bool run( FieldCursor&, FieldSpan* ) { return true; }
+};
+
+template <int Prev, int Col, int... Rest>
+struct Extractor<Prev, Col, Rest...> {
+  static_assert(Col > Prev, "projected columns must be in increasing order");
+
+  static bool run( FieldCursor& fields, FieldSpan* spans ) {
+    return fields.skip(Col - Prev - 1)
+        && fields.next(spans->begin, spans->end)
+        && Extractor<Col, Rest...>::run(fields, spans + 1);
+  }
+};
+
+typedef Extractor<-1, TREE_ID_COLUMN, TREE_DBH_COLUMN, STATUS_COLUMN,
+                  HEALTH_COLUMN, SPC_COMMON_COLUMN, ADDRESS_COLUMN,
+                  ZIPCODE_COLUMN, BORONAME_COLUMN, LATITUDE_COLUMN,
+                  LONGITUDE_COLUMN> TreeExtractor;
+
+// positions of the columns in the array filled by TreeExtractor
+enum Field {
+  TREE_ID, TREE_DBH, STATUS, HEALTH, SPC_COMMON,
+  ADDRESS, ZIPCODE, BORONAME, LATITUDE, LONGITUDE,
+  FIELD_COUNT
+};
+
+std::string lowercase_field( const char* begin, const char* end );
+
+// the names of the values of an enum, indexed by value; the last one is the
+// empty name of its NO_ value
+const std::string BORO_NAMES[NO_BORO + 1] = {
+  "bronx", "manhattan", "brooklyn", "queens", "staten island", ""
+};
+const std::string STATUS_NAMES[NO_STATUS + 1] = { "alive", "dead", "stump", "" };
+const std::string HEALTH_NAMES[NO_HEALTH + 1] = { "good", "fair", "poor", "" };
+
+// returns the index of the name equal to [first,last) ignoring case, or
+// the index of the empty name at the end if there is none
+template <size_t N>
+int lookup_name( const std::string (&names)[N], const char* first, const char* last ) {
+  size_t n = last - first;
+  for ( size_t i = 0; i + 1 < N; ++i ) {
+    const std::string& name = names[i];
+    if (name.size() != n)
+      continue;
+    size_t k = 0;
+    while (k < n && std::tolower(first[k]) == name[k])
+      ++k;
+    if (k == n)
+      return i;
+  }
+  return N - 1;
+}
+
+// interns the lowercased field; short fields are lowercased on the stack
+int intern_lowercase( StringPool& pool, const char* begin, const char* end ) {
+  const size_t MAX_SHORT_FIELD = 128;
+  size_t n = end - begin;
+  if (n > MAX_SHORT_FIELD)
+    return pool.intern(lowercase_field(begin, end));
+  char buf[MAX_SHORT_FIELD];
+  for ( size_t i = 0; i < n; ++i )
+    buf[i] = std::tolower(begin[i]);
+  return pool.intern(buf, buf + n);
+}
+
+std::string lowercase_field( const char* begin, const char* end ) {
+  std::string s(begin, end);
+  for ( auto& c : s )
+    c = std::tolower(c);
+  return s;
+}
+
+// Non-throwing parsers for the numeric fields. Like std::stoi and std::stod
+// they skip leading whitespace and ignore anything after the number; they
+// return false instead of throwing when there is no number or it is out of
+// range.
+
+inline bool is_space( char c ) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool is_digit( char c ) {
+  return c >= '0' && c <= '9';
+}
+
+bool parse_int( const char* p, const char* end, int& value ) {
+  while (p != end && is_space(*p))
+    ++p;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+  if (p == end || !is_digit(*p))
+    return false;
+
+  const long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+  long long n = 0;
+  for ( ; p != end && is_digit(*p); ++p ) {
+    n = n * 10 + (*p - '0');
+    if (n > limit)
+      return false;
   }
-  std::string current_string = "";
-  bool ignore_delims = false;
-  for ( size_t i = 0; i < s.size(); ++i ) {
-    if (s[i] == '"') ignore_delims = !ignore_delims;
-    if (s[i] == delimiter && !ignore_delims) {
-      for ( auto& e : current_string )
-        e = std::tolower(e);
-
-      string_vector.push_back(current_string);
-      current_string = "";
-    } else {
-      current_string += s[i];
+  value = static_cast<int>(negative ? -n : n);
+  return true;
+}
+
+// strtod on a null-terminated copy of the field, for the rare numbers the
+// fast path below does not handle
+bool parse_double_slow( const char* begin, const char* end, double& value ) {
+  const size_t MAX_NUMBER_LENGTH = 64;
+  char buf[MAX_NUMBER_LENGTH];
+  size_t n = std::min(static_cast<size_t>(end - begin), MAX_NUMBER_LENGTH - 1);
+  std::memcpy(buf, begin, n);
+  buf[n] = '\0';
+  char* stop;
+  errno = 0;
+  double result = std::strtod(buf, &stop);
+  if (stop == buf || errno == ERANGE)
+    return false;
+  value = result;
+  return true;
+}
+
+// Plain decimals such as -73.99280743 are read as an integer mantissa and a
+// power of ten. When the mantissa fits in 53 bits and the power is at most
+// 22, both are exact doubles and one multiplication or division gives the
+// correctly rounded result, the same value strtod returns. Anything else
+// (exponents, long mantissas, inf, nan, and hex such as 0x1A, whose
+// leading 0 would otherwise be read as the whole number) goes to strtod.
+bool parse_double( const char* begin, const char* end, double& value ) {
+  static const double POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const unsigned long long MAX_EXACT = 1ULL << 53;
+
+  const char* p = begin;
+  while (p != end && is_space(*p))
+    ++p;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int scale = 0;
+  for ( ; p != end && is_digit(*p); ++p, ++digits )
+    mantissa = mantissa * 10 + (*p - '0');
+  if (p != end && *p == '.') {
+    for ( ++p; p != end && is_digit(*p); ++p, ++digits, ++scale )
+      mantissa = mantissa * 10 + (*p - '0');
+  }
+
+  bool exponent = p != end && (*p == 'e' || *p == 'E');
+  bool hex = p != end && (*p == 'x' || *p == 'X');
+  if (digits == 0 || digits > 19 || exponent || hex || mantissa > MAX_EXACT || scale > 22)
+    return parse_double_slow(begin, end, value);
+
+  double result = static_cast<double>(mantissa) / POWERS_OF_TEN[scale];
+  value = negative ? -result : result;
+  return true;
+}
+
+} // namespace
+
+void TreeParseErrors::add( const TreeParseErrors& other ) {
+  for ( int i = 0; i < FIELD_COUNT; ++i )
+    count[i] += other.count[i];
+}
+
+long TreeParseErrors::total() const {
+  long sum = 0;
+  for ( int i = 0; i < FIELD_COUNT; ++i )
+    sum += count[i];
+  return sum;
+}
+
+std::ostream& operator<<( std::ostream& out, const TreeParseErrors& e ) {
+  static const char* names[TreeParseErrors::FIELD_COUNT] = {
+    "tree_id", "tree_dbh", "zipcode", "latitude", "longitude", "missing fields"
+  };
+  const char* separator = "";
+  for ( int i = 0; i < TreeParseErrors::FIELD_COUNT; ++i ) {
+    if (e.count[i] > 0) {
+      out << separator << names[i] << "=" << e.count[i];
+      separator = ", ";
     }
   }
-  string_vector.push_back(current_string);
-  return string_vector; 
+  return out;
+}
+
+Borough to_borough( const char* first, const char* last ) {
+  return static_cast<Borough>(lookup_name(BORO_NAMES, first, last));
+}
+
+Borough to_borough( const std::string& name ) {
+  return to_borough(name.data(), name.data() + name.size());
 }
 
-//TODO: check for valid values
-Tree::Tree(const std::string& str) {
-  auto data_vector = split(str, ',', 41);
+Status to_status( const char* first, const char* last ) {
+  return static_cast<Status>(lookup_name(STATUS_NAMES, first, last));
+}
+
+Status to_status( const std::string& name ) {
+  return to_status(name.data(), name.data() + name.size());
+}
+
+Health to_health( const char* first, const char* last ) {
+  return static_cast<Health>(lookup_name(HEALTH_NAMES, first, last));
+}
+
+Health to_health( const std::string& name ) {
+  return to_health(name.data(), name.data() + name.size());
+}
+
+const std::string& name_of( Borough b ) { return BORO_NAMES[b]; }
+
+const std::string& name_of( Status s ) { return STATUS_NAMES[s]; }
+
+const std::string& name_of( Health h ) { return HEALTH_NAMES[h]; }
 
-  tree_id = std::stoi(data_vector[0]);
-  tree_dbh = std::stoi(data_vector[3]);
-  status = data_vector[6];
-  health = data_vector[7];
-  spc_common = data_vector[9];
-  zipcode = std::stoi(data_vector[25]);
-  address = data_vector[24];
-  boroname = data_vector[29];
-  latitude = std::stod(data_vector[37]);
-  longitude = std::stod(data_vector[38]);
+TreeDictionaries& TreeDictionaries::standalone() {
+  static TreeDictionaries dicts;
+  return dicts;
+}
+
+Tree::Tree(const std::string& str) : Tree(str.data(), str.data() + str.size()) { }
+
+Tree::Tree(const char* first, const char* last, TreeParseErrors* errors) 
+  : Tree(first, last, TreeDictionaries::standalone(), errors) { }
+
+Tree::Tree(const char* first, const char* last, TreeDictionaries& pools, 
+           TreeParseErrors* errors) {
+  FieldCursor fields(first, last, LONGITUDE_COLUMN + 1);
+  FieldSpan f[FIELD_COUNT];
+  if (!TreeExtractor::run(fields, f)) {
+    if (errors != NULL)
+      errors->count[TreeParseErrors::MISSING_FIELDS]++;
+    return;
+  }
+
+  // every numeric field is checked so that each bad one is counted
+  bool ok[TreeParseErrors::MISSING_FIELDS];
+  ok[TreeParseErrors::TREE_ID] = parse_int(f[TREE_ID].begin, f[TREE_ID].end, tree_id);
+  ok[TreeParseErrors::TREE_DBH] = parse_int(f[TREE_DBH].begin, f[TREE_DBH].end, tree_dbh);
+  ok[TreeParseErrors::ZIPCODE] = parse_int(f[ZIPCODE].begin, f[ZIPCODE].end, zipcode);
+  ok[TreeParseErrors::LATITUDE] = parse_double(f[LATITUDE].begin, f[LATITUDE].end, latitude);
+  ok[TreeParseErrors::LONGITUDE] = parse_double(f[LONGITUDE].begin, f[LONGITUDE].end, longitude);
+
+  bool valid = true;
+  for ( int i = 0; i < TreeParseErrors::MISSING_FIELDS; ++i ) {
+    if (!ok[i]) {
+      valid = false;
+      if (errors != NULL)
+        errors->count[i]++;
+    }
+  }
+  if (!valid) {
+    *this = Tree();
+    return;
+  }
+
+  dicts = &pools;
+  status = to_status(f[STATUS].begin, f[STATUS].end);
+  health = to_health(f[HEALTH].begin, f[HEALTH].end);
+  spc_common = intern_lowercase(pools.species, f[SPC_COMMON].begin, f[SPC_COMMON].end);
+  address = lowercase_field(f[ADDRESS].begin, f[ADDRESS].end);
+  boroname = to_borough(f[BORONAME].begin, f[BORONAME].end);
 }
 
 Tree::Tree(int id, int diam,  std::string stat, std::string hlth, std::string name, 
-        int zip, std::string addr, std::string boro, double lat, double longtd)
-        : tree_id(id), tree_dbh(diam), status(stat), health(hlth), spc_common(name),
-        zipcode(zip), address(addr), boroname(boro), latitude(lat), longitude(longtd) { }
+        int zip, std::string addr, std::string boro, double lat, double longtd,
+        TreeDictionaries* pools)
+        : tree_id(id), tree_dbh(diam), zipcode(zip), status(to_status(stat)), 
+        health(to_health(hlth)), boroname(to_borough(boro)), address(addr), 
+        latitude(lat), longitude(longtd) { 
+  if (pools == NULL)
+    pools = &TreeDictionaries::standalone();
+  dicts = pools;
+  spc_common = pools->species.intern(name);
+}
+
+void Tree::rebind( TreeDictionaries& pools ) {
+  if (dicts == &pools)
+    return;
+  spc_common = pools.species.intern(species_name());
+  dicts = &pools;
+}
+
+Tree Tree::key( const TreeDictionaries& pools, int species, int id ) {
+  Tree t;
+  t.dicts = &pools;
+  t.spc_common = species;
+  t.tree_id = id;
+  return t;
+}
+
+static const std::string NO_NAME;
 
-std::string Tree::common_name() const { return spc_common; }
+const std::string& Tree::species_name() const { 
+  return dicts == NULL ? NO_NAME : dicts->species.name(spc_common); 
+}
 
-std::string Tree::borough_name() const { return boroname; }
+const std::string& Tree::common_name() const { return species_name(); }
 
-std::string Tree::nearest_address() const { return address; }
+const std::string& Tree::borough_name() const { return name_of(boro_code()); }
 
-std::string Tree::life_status() const { return status; }
+const std::string& Tree::nearest_address() const { return address; }
 
-std::string Tree::tree_health() const { return health; }
+const std::string& Tree::life_status() const { return name_of(status_code()); }
+
+const std::string& Tree::tree_health() const { return name_of(health_code()); }
 
 int Tree::id() const { return tree_id; }
 
@@ -95,21 +427,27 @@ std::string Tree::pad_zipcode() const {
   return z;
 }
 std::ostream& operator<<( std::ostream& out, const Tree& t) {
-  out << t.spc_common << "," << t.tree_id << "," << t.tree_dbh << "," << t.status << ",";
-  out << t.health << "," << t.address << "," << t.pad_zipcode() << "," << t.boroname << ",";
+  out << t.species_name() << "," << t.tree_id << "," << t.tree_dbh << "," << name_of(t.status_code()) << ",";
+  out << name_of(t.health_code()) << "," << t.address << "," << t.pad_zipcode() << "," << name_of(t.boro_code()) << ",";
   out << t.latitude << "," << t.longitude;
   return out;
 }
 
 int compare_trees( const Tree& t1, const Tree& t2 )  {
-  if ( t1.spc_common.size() > t2.spc_common.size() )
+  // the same code in the same pool is the same name
+  if ( t1.dicts == t2.dicts && t1.spc_common == t2.spc_common )
+    return 0;
+
+  const std::string& name1 = t1.species_name();
+  const std::string& name2 = t2.species_name();
+  if ( name1.size() > name2.size() )
     return 1;
-  else if ( t1.spc_common.size() < t2.spc_common.size() )
+  else if ( name1.size() < name2.size() )
     return -1;
   else {
-    for ( size_t i = 0; i < t1.spc_common.size(); ++i ) {
-      char this_i = tolower(t1.spc_common[i]);
-      char other_i = tolower(t2.spc_common[i]);
+    for ( size_t i = 0; i < name1.size(); ++i ) {
+      char this_i = tolower(name1[i]);
+      char other_i = tolower(name2[i]);
       if ( this_i != other_i && (this_i != '-'
             || this_i != ' ') && (other_i != '-' || other_i != ' ')) {
               return this_i > other_i ? 1 : -1;
@@ -42,12 +42,115 @@ Data Dictionary for Input File:
 
 #include <string>
 #include <iostream>
+#include <cstdint>
+
+#include "string_pool.h"
 using namespace std;
 
+/** struct TreeParseErrors
+ *  Counts the problems found while parsing csv rows into trees, by field:
+ *  numeric fields that could not be read and rows with too few fields.
+ *  A row with any such problem becomes an empty tree.
+ */
+struct TreeParseErrors
+{
+    enum Field {
+        TREE_ID = 0,
+        TREE_DBH,
+        ZIPCODE,
+        LATITUDE,
+        LONGITUDE,
+        MISSING_FIELDS,
+        FIELD_COUNT
+    };
+
+    long count[FIELD_COUNT] = {};
+
+    /** add(other) adds the counts of other to these counts */
+    void add(const TreeParseErrors & other);
+
+    /** total() returns the sum of the counts of all fields */
+    long total() const;
+
+    /** operator<<(os,e) writes the non-zero counts as "field=count" pairs */
+    friend ostream& operator<< (ostream & os, const TreeParseErrors & e);
+};
+
+
+/** enum Borough, Status, Health
+ *  The values of the borough, status and health columns. They are decoded
+ *  once, when a tree is built, so that queries compare small integers
+ *  instead of strings. A name outside the vocabulary of the data dictionary,
+ *  including the empty string, becomes the NO_ value of its enum. The
+ *  boroughs are numbered in the order in which they are reported.
+ */
+//should use enum class but dont want to keep writing static_cast
+enum Borough {
+    BRONX = 0,
+    MANHATTAN,
+    BROOKLYN,
+    QUEENS,
+    STATEN_ISLAND,
+    NO_BORO,
+    BORO_COUNT = NO_BORO
+};
+
+enum Status {
+    ALIVE = 0,
+    DEAD,
+    STUMP,
+    NO_STATUS
+};
+
+enum Health {
+    GOOD = 0,
+    FAIR,
+    POOR,
+    NO_HEALTH
+};
+
+/** to_borough(first,last), to_status(first,last), to_health(first,last)
+ *  return the value named by [first,last), compared case insensitively,
+ *  or the NO_ value of the enum if there is none.
+ */
+Borough to_borough( const char * first, const char * last );
+Borough to_borough( const string & name );
+Status  to_status( const char * first, const char * last );
+Status  to_status( const string & name );
+Health  to_health( const char * first, const char * last );
+Health  to_health( const string & name );
+
+/** name_of(value) returns the lowercase name of value, as stored in the
+ *  input file, or the empty string for a NO_ value.
+ */
+const string & name_of( Borough b );
+const string & name_of( Status s );
+const string & name_of( Health h );
+
+
+/** struct TreeDictionaries
+ *  The string pool that the species code of a Tree refers to. A
+ *  TreeCollection owns one set shared by all of its trees. Trees built 
+ *  elsewhere keep the set they were built with until a collection rebinds
+ *  them to its own.
+ */
+struct TreeDictionaries
+{
+    StringPool species;
+
+    /** standalone() returns the set used by trees built without one. It is
+     *  not meant to be shared between threads.
+     */
+    static TreeDictionaries& standalone();
+};
+
+
 /** class Tree
  *  The Tree class represents an individual tree from the NYC Open Data
  *  2015 Tree Census. Only ten of the data members are stored in an object of
- *  class Tree, as described above.
+ *  class Tree, as described above. The status, health and borough are
+ *  stored as enum values, and the species as a code into a set of
+ *  TreeDictionaries; the accessors turn them back into names.
  */
 class Tree
 {
@@ -66,13 +169,45 @@ public:
      */
     Tree(const string & str) ;
 
+    /** Tree(first,last) is a constructor that parses a csv row in place.
+     *  [first,last) must hold exactly one row of the input file, without its
+     *  trailing newline. The fields are located directly in the buffer and
+     *  only the ten listed above are copied out of it; the rest are skipped.
+     *  Fields are split and lowercased exactly as Tree(str) does. If the row
+     *  has fewer fields than expected or a numeric field cannot be read, it
+     *  creates an empty tree, and if errors is not NULL the problem is 
+     *  counted in it. Nothing is thrown.
+     */
+    Tree(const char * first, const char * last, TreeParseErrors * errors = NULL);
+
+    /** Tree(first,last,dicts,errors) is the same as Tree(first,last,errors)
+     *  but interns its strings into dicts instead of the standalone set.
+     */
+    Tree(const char * first, const char * last, TreeDictionaries & dicts,
+         TreeParseErrors * errors = NULL);
+
     /** A constructor that expects ten values exactly as specified in the.
      *  data dictionary above. 
      *  This constructor does not validate the values - it assumes they have
-     *  been validated before the call.
+     *  been validated before the call. The strings are interned into dicts,
+     *  or into the standalone set if dicts is NULL.
      */
     Tree(int id, int diam,  string stat, string hlth, string name, 
-        int zip, string addr, string boro, double lat, double longtd);
+        int zip, string addr, string boro, double lat, double longtd,
+        TreeDictionaries * dicts = NULL);
+
+    /** rebind(dicts) re-interns the species of this tree into dicts,
+     *  so that its codes can be compared with those of other trees in dicts.
+     *  @param TreeDictionaries dicts [inout] the set to move to
+     */
+    void rebind(TreeDictionaries & dicts);
+
+    /** key(dicts,species,id) returns an otherwise empty tree with the given
+     *  id and the species of code species in dicts, which must already be
+     *  there. Nothing is interned, so a search key can be made for a name
+     *  found with dicts.species.find without changing any pool.
+     */
+    static Tree key(const TreeDictionaries & dicts, int species, int id);
 
     /** operator<<(os,t)  Overloaded stream insertion operator
      *  writes the Tree t onto the stream os as a comma-separated-values string
@@ -133,42 +268,60 @@ public:
      *  The next nine methods are accessor functions that retrieve the value
      *  of the corresponding private data member. Their meaning should be
      *  clear, possibly except for life_status(), which returns the tree's status
-     *  member, and the tree_health() which returns its health member.
+     *  member, and the tree_health() which returns its health member. The
+     *  strings are returned by reference and live as long as the tree's
+     *  dictionaries, so no accessor allocates.
      */
-    string common_name() const;
-    string borough_name() const;
-    string nearest_address() const;
-    string life_status() const;
-    string tree_health() const;
+    const string & common_name() const;
+    const string & borough_name() const;
+    const string & nearest_address() const;
+    const string & life_status() const;
+    const string & tree_health() const;
     int id()       const;
     int zip_code() const;
     int diameter() const;
     void get_position(double & latitude,double & longitude) const;
 
+    /** The decoded status, health and borough, and the code of the species
+     *  in dictionaries(). Two trees with the same dictionaries have equal
+     *  species names exactly when they have equal species codes.
+     */
+    Status  status_code()  const { return static_cast<Status>(status); }
+    Health  health_code()  const { return static_cast<Health>(health); }
+    int     species_code() const { return spc_common; }
+    Borough boro_code()    const { return static_cast<Borough>(boroname); }
+    const TreeDictionaries * dictionaries() const { return dicts; }
+
 
 private:
+    const TreeDictionaries * dicts = NULL; // the pool spc_common refers
+                       //        to; NULL only for an empty tree
     int    tree_id = -0;    // unique id that  identifies the tree
     int    tree_dbh = -1;   // specifies tree diameter
-    string status = "";     // valid values: ”Alive”, ”Dead”, ”Stump”, or the 
-                       //        empty string 
-    string health = "";     // valid values: ”Good”, ”Fair”, ”Poor”, or the 
-                       //         empty string
-    string spc_common = ""; // the common name of the tree, such as “white oak” 
-                       //        or a possibly empty string
     int    zipcode = -1;    // positive five digit integer (This means that any 
                        //         number from 0 to 99999 is acceptable. The values 
                        //         that are shorter are treated as if they had 
                        //         leading zeroes
+    uint32_t spc_common = 0; // code of the common name of the tree, such as
+                       //        “white oak” or a possibly empty string; as
+                       //        wide as the codes of a StringPool can grow
+    uint8_t status = NO_STATUS; // a Status: ”Alive”, ”Dead”, ”Stump”, or
+                       //        the empty string 
+    uint8_t health = NO_HEALTH; // a Health: ”Good”, ”Fair”, ”Poor”, or 
+                       //        the empty string
+    uint8_t boroname = NO_BORO; // a Borough: ”Manhattan”, ”Bronx”, 
+                       //        ”Brooklyn”, ”Queens”, ”Staten Island”
     string address = "";    // street address nearest to tree
 
-    string boroname = "";   // valid values: ”Manhattan”, ”Bronx”, ”Brooklyn”, 
-                       //        ”Queens”, ”Staten Island”
     double latitude = 0.0;   // Latitude of point, in decimal degrees
                        
     double longitude = 0.0;  // Longitude of point, in decimal degrees
 
     string pad_zipcode() const; // prints zipcode by adding leading zeroes if necessary
 
+    // the species name behind the code, or the empty string for an empty tree
+    const string & species_name() const;
+
     //compares two tree species case insenitively
     //space and hyphen are treated as the same character
     // returns 0 if trees are same, 1 if *this is bigger, -1 if *this is smaller
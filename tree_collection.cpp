@@ -8,36 +8,202 @@
   Usage          : 
   Build with     : -std=c++11 -lm
 *******************************************************************************/
-#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <cmath>
+#include <climits>
 #include <iostream>
 #include <locale>
+#include <thread>
 
 #include "tree_collection.h"
 #include "tree_species.h"
 #include "tree.h"
+#include "parallel_sort.h"
+#include "parallel_for.h"
+#include "haversine.h"
 
 TreeCollection::TreeCollection() : trees( Tree() ) { }
 
+void TreeCollection::rebuild_columns() const {
+  columns.clear();
+  columns.reserve(size);
+  for ( const Tree& t : trees )
+    columns.push_back(t);
+  grid.build(columns);
+  columns_stale = false;
+}
+
+const TreeColumns& TreeCollection::column_view() const {
+  if (columns_stale) {
+    std::lock_guard<std::mutex> hold(columns_lock);
+    if (columns_stale)    // unless another query has just rebuilt them
+      rebuild_columns();
+  }
+  return columns;
+}
+
 int TreeCollection::total_tree_count() {
   return size;
 }
 
-int TreeCollection::count_of_tree_species( const std::string& spc_name ) {
-  // return species_map.count(spc_name) > 0 ? species_map[spc_name] : 0;
-  return trees.countIf([&](const Tree& t) {
-    return t.common_name() == spc_name;
+Tree TreeCollection::species_key( int species, int id ) const {
+  return Tree::key(dicts, species, id);
+}
+
+std::pair<TreeCollection::const_iterator, TreeCollection::const_iterator>
+TreeCollection::species_range( const std::string& spc_name ) const {
+  int species = dicts.species.find(spc_name);
+  if (species == StringPool::NOT_FOUND)
+    return std::make_pair(trees.end(), trees.end());
+  return std::make_pair(trees.lower_bound(species_key(species, INT_MIN)),
+                        trees.upper_bound(species_key(species, INT_MAX)));
+}
+
+std::vector<TreeCollection::SpeciesRun> TreeCollection::species_runs() const {
+  std::vector<SpeciesRun> runs;
+  int n = trees.size();
+  for ( int row = 0; row < n; row = runs.back().end ) {
+    const Tree& t = trees.select(row);
+    int count = trees.countRange(species_key(t.species_code(), INT_MIN),
+                                 species_key(t.species_code(), INT_MAX));
+    SpeciesRun run = { t.species_code(), row, row + count };
+    runs.push_back(run);
+  }
+  return runs;
+}
+
+void TreeCollection::assign_species_rows() {
+  for ( int c = species_row.size(); c < dicts.species.size(); ++c ) {
+    auto entry = row_of_name.emplace(dicts.species.lowercase(c), species_counts.size());
+    if (entry.second) {
+      species_counts.push_back(SpeciesCounts());
+      row_species.push_back(c);
+      row_matches.push_back(RowMatches());
+    }
+    species_row.push_back(entry.first->second);
+  }
+}
+
+std::vector<int> TreeCollection::rows_matching( const std::string& query ) const {
+  std::vector<int> rows;
+  auto named = row_of_name.find(query);
+  if (named == row_of_name.end()) {
+    for ( const auto& entry : row_of_name ) {
+      if (species_counts[entry.second].total > 0 &&
+          is_matching_lowercase_species(entry.first, query))
+        rows.push_back(entry.second);
+    }
+    return rows;
+  }
+
+  std::lock_guard<std::mutex> hold(matches_lock);
+  RowMatches& matches = row_matches[named->second];
+  for ( ; matches.tested < species_counts.size(); ++matches.tested ) {
+    int row = static_cast<int>(matches.tested);
+    if (is_matching_lowercase_species(dicts.species.lowercase(row_species[row]), query))
+      matches.rows.push_back(row);
+  }
+  for ( int row : matches.rows ) {
+    if (species_counts[row].total > 0)
+      rows.push_back(row);
+  }
+  return rows;
+}
+
+const TreeCollection::SpeciesCounts* TreeCollection::counts_of( int species ) const {
+  if (species < 0 || species >= static_cast<int>(species_row.size()))
+    return NULL;
+  return &species_counts[species_row[species]];
+}
+
+void TreeCollection::count_species( const Tree& t, int delta ) {
+  assign_species_rows();
+  SpeciesCounts& counts = species_counts[species_row[t.species_code()]];
+  counts.total += delta;
+  counts.by_boro.count[t.boro_code()] += delta;
+  boro_totals.count[t.boro_code()] += delta;
+}
+
+// Each species run is one key range, whose borough counts come from the
+// subtree summaries, so the recount takes O(log n) per species.
+void TreeCollection::rebuild_species_counts() {
+  assign_species_rows();
+  std::fill(species_counts.begin(), species_counts.end(), SpeciesCounts());
+  for ( const SpeciesRun& run : species_runs() ) {
+    SpeciesCounts& counts = species_counts[species_row[run.species]];
+    counts.total = run.end - run.begin;
+    counts.by_boro = trees.summarizeRange(species_key(run.species, INT_MIN),
+                                          species_key(run.species, INT_MAX));
+  }
+  boro_totals = trees.summary();
+}
+
+// Trees sort by the length of their species names and then by the names
+// ignoring case, comparing chars as compare_trees does; given lowercased
+// names, returns -1, 0 or 1 as a sorts before, with or after b.
+static int compare_lowercase_names( const std::string& a, const std::string& b ) {
+  if (a.size() != b.size())
+    return a.size() < b.size() ? -1 : 1;
+  for ( size_t i = 0; i < a.size(); ++i ) {
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+// ties keep code order
+bool TreeCollection::species_before( int a, int b ) const {
+  int order = compare_lowercase_names(dicts.species.lowercase(a), dicts.species.lowercase(b));
+  return order != 0 ? order < 0 : a < b;
+}
+
+void TreeCollection::count_in_zipcode( const Tree& t, int delta ) {
+  std::vector<ZipSpecies>& histogram = zip_species[t.zip_code()];
+  int species = t.species_code();
+  auto entry = std::lower_bound(histogram.begin(), histogram.end(), species,
+      [this]( const ZipSpecies& e, int code ) { return species_before(e.species, code); });
+  if (entry == histogram.end() || entry->species != species)
+    entry = histogram.insert(entry, ZipSpecies{species, 0});
+  entry->count += delta;
+  if (entry->count == 0) {
+    histogram.erase(entry);
+    if (histogram.empty())
+      zip_species.erase(t.zip_code());
+  }
+}
+
+void TreeCollection::rebuild_zip_species() {
+  zip_species.clear();
+  // in tree order each zipcode's species mostly arrive already sorted, so
+  // only a new species needs the search of count_in_zipcode
+  trees.visitInOrder([this]( const Tree& t ) {
+    std::vector<ZipSpecies>& histogram = zip_species[t.zip_code()];
+    if (!histogram.empty() && histogram.back().species == t.species_code())
+      ++histogram.back().count;
+    else
+      count_in_zipcode(t, 1);
   });
 }
 
+int TreeCollection::count_of_tree_species( const std::string& spc_name ) {
+  const SpeciesCounts* counts = counts_of(dicts.species.find(spc_name));
+  return counts == NULL ? 0 : counts->total;
+}
+
 int TreeCollection::count_of_tree_species_in_boro( const std::string& spc_name, 
   const std::string& boro_name) {
 
-  return trees.countIf([&](const Tree& t) {
-    return t.common_name() == spc_name && t.borough_name() == boro_name;
-  });   
+  const SpeciesCounts* counts = counts_of(dicts.species.find(spc_name));
+  Borough boro = to_borough(boro_name);
+  if (counts == NULL || boro == NO_BORO)
+    return 0;
+  return counts->by_boro.count[boro];
 }
 
+std::string tolower(const std::string& s);
+
 std::string remove_leading_whitespace(const std::string& s) {
   int i = 0;
   for (; i < s.size(); ++i) {
@@ -50,49 +216,15 @@ std::string remove_leading_whitespace(const std::string& s) {
 
 int TreeCollection::get_counts_of_trees_by_boro ( const std::string& spc_name, boro tree_count[5] ) {
   std::string ns = remove_leading_whitespace(spc_name);
-  std::cout << "GET_COUNTS_OF_TREES_BY_BORO\n";
-  // for ( int b = BRONX; b < BORO_COUNT; ++b ) {
-  //   switch (b) {
-      // case BRONX:
-        //std::cout << tree_count[BRONX].name << "\n";
-        tree_count[BRONX].count = trees.countIf([&](const Tree& t){
-          //std::cout << t.borough_name() << "\n";
-          return t.borough_name() == "bronx" && is_matching_species(t.common_name(),ns);
-        });
-        // break;
-
-      // case MANHATTAN:
-        //std::cout << tree_count[MANHATTAN].name << "\n";
-        tree_count[MANHATTAN].count = trees.countIf([&](const Tree& t){
-          // std::cout << t.borough_name() << "\n";
-          return t.borough_name() == "manhattan" && is_matching_species(t.common_name(),ns);
-        });
-        // break;
-
-      // case BROOKLYN:
-        //std::cout << tree_count[BROOKLYN].name << "\n";
-        tree_count[BROOKLYN].count = trees.countIf([&](const Tree& t){
-          // std::cout << t.borough_name() << "\n";
-          return t.borough_name() == "brooklyn" && is_matching_species(t.common_name(),ns);
-        });
-        // break;
-
-      // case QUEENS:
-        //std::cout << tree_count[QUEENS].name << "\n";
-        tree_count[QUEENS].count = trees.countIf([&](const Tree& t){
-          // std::cout << t.borough_name() << "\n";
-          return t.borough_name() == "queens" && is_matching_species(t.common_name(),ns);
-        });
-        // break;
-
-      // default:
-        //std::cout << tree_count[STATEN_ISLAND].name << "\n";
-        tree_count[STATEN_ISLAND].count = trees.countIf([&](const Tree& t){
-          // std::cout << t.borough_name() << "\n";
-          return t.borough_name() == "staten island" && is_matching_species(t.common_name(),ns);
-        });
-  //   }
-  // }
+  std::string query = tolower(ns);
+
+  // each species is one row of the matrix, matched by its lowercased name
+  // as get_matching_species matches it
+  BoroughCounts::value_type counts;
+  for ( int row : rows_matching(query) )
+    counts = BoroughCounts::combine(counts, species_counts[row].by_boro);
+  for ( int b = BRONX; b < BORO_COUNT; ++b )
+    tree_count[b].count = counts.count[b];
 
   int sum = 0;
   for (int i = 0; i < BORO_COUNT; ++i) {
@@ -101,21 +233,22 @@ int TreeCollection::get_counts_of_trees_by_boro ( const std::string& spc_name, b
   return sum;
 }
 
-std::string tolower(const std::string& s);
-
 int TreeCollection::count_of_trees_in_boro( const std::string& boro_name ) {
-  return trees.countIf([&boro_name](const Tree& t) {
-    // std::cout << "TreeCollection::count_of_trees_in_boro: ";
-    // std::cout << "Comparing \"" << t.borough_name() << "\" and " << boro_name  << "\n";
-    auto ns = tolower(boro_name);
-    return t.borough_name() == ns;
-  });
+  Borough boro = to_borough(boro_name);
+  if (boro == NO_BORO)
+    return 0;
+  return boro_totals.count[boro];
 }
 
-int TreeCollection::add_tree( Tree& tree ) {
+int TreeCollection::add_tree( Tree& new_tree ) {
+  Tree tree = new_tree;
+  tree.rebind(dicts);
   int result = trees.insert(tree);
 
   if (result) {
+    columns_stale = true;
+    count_species(tree, 1);
+    count_in_zipcode(tree, 1);
     if (!tree_species.contains(tree.common_name())) {
       tree_species.add_species(tree.common_name());
       // std::cout << "add_tree: adding " << tree << "\n";
@@ -127,112 +260,203 @@ int TreeCollection::add_tree( Tree& tree ) {
   return result;
 } 
 
+int TreeCollection::add_trees( std::vector<Tree>& batch, unsigned num_threads ) {
+  // rebinding first lets the sort compare species by code
+  for ( auto& tree : batch )
+    tree.rebind(dicts);
+
+  // a stable sort followed by unique keeps the first of each run of equal
+  // keys, which is the one add_tree would have kept
+  if (!std::is_sorted(batch.begin(), batch.end()))
+    parallel_stable_sort(batch.begin(), batch.end(), num_threads);
+  batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+  std::string last_name;
+  for ( const auto& tree : batch ) {
+    if (tree.common_name() != last_name || &tree == &batch.front()) {
+      last_name = tree.common_name();
+      if (!tree_species.contains(last_name))
+        tree_species.add_species(last_name);
+    }
+  }
+
+  int added = trees.insertSorted(std::make_move_iterator(batch.begin()),
+                                 std::make_move_iterator(batch.end()));
+  size += added;
+  if (added > 0) {
+    rebuild_columns();
+    rebuild_species_counts();
+    rebuild_zip_species();
+  }
+  return added;
+}
+
+int TreeCollection::remove_tree( const Tree& tree ) {
+  // the stored copy has the collection's species code, which tree may not
+  auto it = trees.lower_bound(tree);
+  if (it == trees.end() || tree < *it)
+    return 0;
+  int species = it->species_code();
+  Tree key = *it;
+  trees.remove(key);
+  size--;
+  columns_stale = true;
+  count_species(key, -1);
+  count_in_zipcode(key, -1);
+
+  const std::string& name = dicts.species.name(species);
+  bool present = false;
+  trees.visitRange(species_key(species, INT_MIN), species_key(species, INT_MAX),
+                   [&present, species](const Tree& t) {
+    present = present || t.species_code() == species;
+  });
+  if (!present)
+    tree_species.remove_species(name);
+  return 1;
+}
+
+int TreeCollection::remove_stumps() {
+  return remove_if([](const Tree& t) {
+    return t.status_code() == STUMP;
+  });
+}
+
+void TreeCollection::forget_missing_species() {
+  std::vector<bool> present(dicts.species.size());
+  for ( const Tree& t : trees )
+    present[t.species_code()] = true;
+  for ( int c = 0; c < dicts.species.size(); ++c ) {
+    if (!present[c])
+      tree_species.remove_species(dicts.species.name(c));
+  }
+}
+
 void TreeCollection::print_all_species( std::ostream& os ) const {
   tree_species.print_all_species(os);
 }
 
 void TreeCollection::print ( std::ostream& out ) const {
-  trees.printTreeToStream(out);
+  for ( const Tree& t : trees )
+    out << t << "\n";
 }
 
 
 std::list<std::string> 
 TreeCollection::get_matching_species( const std::string& s ) const {
   std::string ns = remove_leading_whitespace(s);
-  // temp is a list of tree references
-  // auto temp =  trees.findAllIf([&](const Tree& t) {
-  //   std::cout << "comparing: " << t.common_name() << " and " << s <<"\n";
-  //   return is_matching_species(t.common_name(),ns);
-  // }, 
-  // [&](const Tree& t) {
-  //   Tree dummy(-1,-1,"","",ns,0,"","",0,0);
-  //   int result = compare_trees(dummy,t);
-  //   // switch (result)
-  //   // {
-  //   // case 1:
-  //   //   std::cout << "result is 1, going right!\n";
-  //   //   break;
-  //   // case  0:
-  //   //   std::cout << "result is 0, going nowhere!\n";
-  //   //   break;
-  //   // case -1:
-  //   //   std::cout << "result is -1, going left!\n";
-  //   //   break;
-  //   // }
-  //   return result;
-  // });
-
-  //below "works" but is inefficient
-
-  auto temp = trees.collectIntoListIf([&ns](const Tree& t) {
-    //std::cout << t.common_name() << "\t\t" << ns << " ";
-    //std::cout << std::boolalpha;
-    //std::cout << is_matching_species(t.common_name(),ns) << "\n";
-    return is_matching_species(t.common_name(),ns);
+
+  // each species with trees is one row of the matrix, matched by its
+  // lowercased name against the lowercased query. The rows are listed
+  // in descending tree order, as they always have been, each under the
+  // spelling of its first tree.
+  std::vector<int> rows = rows_matching(tolower(ns));
+  std::sort(rows.begin(), rows.end(), [this]( int a, int b ) {
+    return compare_lowercase_names(dicts.species.lowercase(row_species[a]),
+                                   dicts.species.lowercase(row_species[b])) > 0;
   });
 
-  std::unordered_set<std::string> set;
   std::list<std::string> result;
-
-  for ( const auto& e : temp ) {
-    if (set.count(e.common_name()) == 0) {
-      result.push_back(e.common_name());
-      set.insert(e.common_name());
-    }
+  for ( int row : rows ) {
+    auto first = trees.lower_bound(species_key(row_species[row], INT_MIN));
+    result.push_back(dicts.species.name(first->species_code()));
   }
   return result;
 }
 
-std::list<std::string> TreeCollection::get_all_in_zipcode( int zipcode ) const {
-  auto trs = trees.collectIntoListIf([zipcode](const Tree& t) {
-    return t.zip_code() == zipcode;
+void TreeCollection::set_threads( unsigned threads ) {
+  num_threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+// the rows i in [0,rows) for which match(i) holds, last first. The rows
+// are cut into slices that are scanned concurrently, each listing its
+// matches last first, and the lists are joined from the last slice down.
+template <class Match>
+std::vector<int> matching_rows_descending( size_t rows, unsigned num_threads,
+                                           const Match& match ) {
+  size_t slices = std::min<size_t>(std::max(1u, num_threads) * 8, rows / PARALLEL_CUTOFF + 1);
+  std::vector<std::vector<int> > found(slices);
+  parallel_for(slices, rows, num_threads, [&]( size_t s ) {
+    size_t begin = rows * s / slices;
+    for ( size_t i = rows * (s + 1) / slices; i-- > begin; ) {
+      if (match(i))
+        found[s].push_back(i);
+    }
   });
+  if (slices == 1)
+    return std::move(found[0]);
+  std::vector<int> result;
+  for ( size_t s = slices; s-- > 0; )
+    result.insert(result.end(), found[s].begin(), found[s].end());
+  return result;
+}
 
-  //std::unordered_set<std::string> set;
+std::list<std::string> TreeCollection::get_all_in_zipcode( int zipcode ) const {
   std::list<std::string> result;
 
-  for ( const auto& e : trs ) {
-    //if (set.count(e.common_name()) == 0) {
-      result.push_back(e.common_name());
-      //set.insert(e.common_name());
-    //}
-  }
-
+  // descending tree order
+  const TreeColumns& c = column_view();
+  auto in_zipcode = [&c, zipcode]( size_t i ) { return c.zipcode[i] == zipcode; };
+  for ( int i : matching_rows_descending(c.size(), num_threads, in_zipcode) )
+    result.push_back(dicts.species.name(c.species[i]));
   return result;
 }
 
-constexpr double R = 6372.8; //radius of the earth in km
-constexpr double TO_RAD = M_PI / 180.0; //conversion of degrees to rads
-
-double haversine( double lat1, double lon1, double lat2, double lon2 ) {
-  lat1 = TO_RAD * lat1;
-  lat2 = TO_RAD * lat2;
-  lon1 = TO_RAD * lon1;
-  lon2 = TO_RAD * lon2;
-  double dLat = (lat2 - lat1)/2;
-  double dLon = (lon2 - lon1)/2;
-  double a = sin(dLat);
-  double b = sin(dLon);
-
-  return 2 * R * asin(sqrt(a*a + cos(lat1)*cos(lat2)*b*b));
+std::list<std::pair<std::string, int> >
+TreeCollection::get_species_in_zipcode( int zipcode ) const {
+  std::list<std::pair<std::string, int> > result;
+  auto entry = zip_species.find(zipcode);
+  if (entry == zip_species.end())
+    return result;
+  for ( auto s = entry->second.rbegin(); s != entry->second.rend(); ++s )
+    result.emplace_back(dicts.species.name(s->species), s->count);
+  return result;
 }
 
 std::list<std::string> TreeCollection::get_all_near( double lat, double lgt, double dntc ) const {
-  auto trs = trees.collectIntoListIf([&]( const Tree& t) {
-    double t_lat, t_lon;
-    t.get_position(t_lat,t_lon);
-    return haversine( lat, lgt, t_lat, t_lon ) <= dntc;
-  });
-
-  //std::unordered_set<std::string> set;
   std::list<std::string> result;
 
-  for ( const auto& e : trs ) {
-    //if (set.count(e.common_name()) == 0) {
-      result.push_back(e.common_name());
-      //set.insert(e.common_name());
-    //}
+  // no distance is within a negative or NaN dntc
+  if (!(dntc >= 0))
+    return result;
+  const TreeColumns& c = column_view();
+  auto is_near = [&]( size_t i ) {
+    return haversine( lat, lgt, c.latitude[i], c.longitude[i] ) <= dntc;
+  };
+
+  // descending tree order
+  double lat_lo, lat_hi, lon_lo, lon_hi;
+  if (!std::isfinite(lat) || !std::isfinite(lgt) ||
+      !haversine_box(lat, lgt, dntc, lat_lo, lat_hi, lon_lo, lon_hi)) {
+    for ( int i : matching_rows_descending(c.size(), num_threads, is_near) )
+      result.push_back(dicts.species.name(c.species[i]));
+    return result;
   }
 
+  // only the rows of the grid cells overlapping the box are tested, a
+  // span of cells at a time, by the batched kernel; haversine decides the
+  // few it cannot
+  std::vector<TreeGrid::Span> spans = grid.spans_in_box(lat_lo, lat_hi, lon_lo, lon_hi);
+  HaversineQuery query(lat, lgt, dntc);
+  size_t candidates = 0;
+  for ( const auto& span : spans )
+    candidates += span.second - span.first;
+  std::vector<std::vector<int> > found(spans.size());
+  parallel_for(spans.size(), candidates, num_threads, [&]( size_t s ) {
+    std::vector<int> borderline;
+    haversine_select(grid.points(), spans[s].first, spans[s].second, query,
+                     found[s], borderline);
+    for ( int& k : found[s] )
+      k = grid.row(k);
+    for ( int k : borderline ) {
+      if (is_near(grid.row(k)))
+        found[s].push_back(grid.row(k));
+    }
+  });
+  std::vector<int> near;
+  for ( const auto& rows : found )
+    near.insert(near.end(), rows.begin(), rows.end());
+  std::sort(near.begin(), near.end(), std::greater<int>());
+  for ( int i : near )
+    result.push_back(dicts.species.name(c.species[i]));
   return result;
 }
\ No newline at end of file
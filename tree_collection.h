@@ -14,21 +14,82 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <utility>
 #include <iostream>
-// #include <unordered_map>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 #include "__tree_collection.h"
 #include "AvlTree.h"
+#ifdef TREE_COLLECTION_BPLUS
+#include "BPlusTree.h"
+#endif
 #include "tree.h"
+#include "tree_columns.h"
+#include "tree_grid.h"
 #include "tree_species.h"
 
 
+/** struct BoroughCounts
+ *  The augmentation (see augment.h) with which every subtree of a
+ *  TreeCollection counts its trees in each borough; slot NO_BORO counts
+ *  the trees with no borough.
+ */
+struct BoroughCounts {
+  struct value_type {
+    int count[NO_BORO + 1];
+    value_type() : count() { }
+  };
+
+  static value_type of( const Tree& t ) {
+    value_type v;
+    v.count[t.boro_code()] = 1;
+    return v;
+  }
+
+  static value_type combine( const value_type& a, const value_type& b ) {
+    value_type v;
+    for ( int i = 0; i <= NO_BORO; ++i )
+      v.count[i] = a.count[i] + b.count[i];
+    return v;
+  }
+};
+
 //for documentation of the functions, go to __TreeCollection.h
 class TreeCollection : public __TreeCollection {
 public:
 
+  // the ordered container of the trees: an AVL tree, or a B+tree when
+  // built with -DTREE_COLLECTION_BPLUS. Both come with the same operations,
+  // and both keep BoroughCounts for every subtree.
+#ifdef TREE_COLLECTION_BPLUS
+  typedef BPlusTree<Tree, ArenaNodePool, BoroughCounts> Container;
+#else
+  typedef AvlTree<Tree, ArenaNodePool, BoroughCounts> Container;
+#endif
+  typedef Container::const_iterator const_iterator;
+
   TreeCollection();
 
+  /** A collection is not copied: its trees refer to its own
+   *  TreeDictionaries, which a copy's trees would go on pointing at.
+   */
+  TreeCollection( const TreeCollection& ) = delete;
+  TreeCollection& operator=( const TreeCollection& ) = delete;
+
+  /** begin(), end() iterate over the trees in (species, id) order, the
+   *  order in which print() writes them
+   */
+  const_iterator begin() const { return trees.begin(); }
+  const_iterator end() const { return trees.end(); }
+
+  /** species_range(s) returns the [first,last) range of the trees whose
+   *  species sorts equal to s. It is empty if no tree has species s.
+   */
+  std::pair<const_iterator, const_iterator> species_range( const std::string& spc_name ) const;
+
   int total_tree_count();
 
   int count_of_tree_species( const std::string& species_name );
@@ -42,6 +103,48 @@ public:
 
   int add_tree( Tree& new_tree );
 
+  /** add_tree(t) also rebinds the inserted copy of t to the collection's
+   *  own TreeDictionaries; see __tree_collection.h for the rest.
+   *
+   *  add_trees(batch,num_threads) inserts every tree of batch, with the
+   *  same result as calling add_tree on each of them in order: of trees with
+   *  equal keys only the first one is kept. The batch is sorted, with
+   *  num_threads threads, and bulk-loaded in linear time. Its contents are
+   *  left in an unspecified order.
+   *
+   *  The columns that get_all_in_zipcode and get_all_near scan are rebuilt
+   *  by add_trees and remove_if. After add_tree or remove_tree, the next of
+   *  those queries rebuilds them first, in O(n).
+   *  @return int the number of trees inserted
+   */
+  int add_trees( std::vector<Tree>& batch, unsigned num_threads = 1 );
+
+  /** set_threads(n) lets the queries that scan many trees, get_all_near
+   *  and get_all_in_zipcode, run on up to n threads; 0 means one per
+   *  hardware core. Their results are the same for any n. The default is 1.
+   */
+  void set_threads( unsigned num_threads );
+
+  /** remove_tree(t) removes the tree with the same key as t in O(log n)
+   *  time; its species is forgotten if no other tree has it.
+   *  @return int 1 if the tree was found and removed, 0 otherwise
+   */
+  int remove_tree( const Tree& tree );
+
+  /** remove_if(p) removes every tree t for which p(t) is true. The
+   *  collection is rebuilt from the remaining trees in linear time, which
+   *  beats removing them one at a time when many trees go. Species no
+   *  tree has any more are forgotten.
+   *  @return int the number of trees removed
+   */
+  template <class Predicate>
+  int remove_if( const Predicate& p );
+
+  /** remove_stumps() removes every tree whose status is stump
+   *  @return int the number of trees removed
+   */
+  int remove_stumps();
+
   void print_all_species( std::ostream& out ) const;
 
   void print( std::ostream& out ) const;
@@ -50,9 +153,19 @@ public:
 
   std::list<std::string> get_all_in_zipcode( int zipcode ) const;
 
+  /** get_species_in_zipcode(z) returns each species of the trees in zipcode
+   *  z with its number of trees there, in descending species order, the
+   *  order in which get_all_in_zipcode lists the trees. It is read from an
+   *  index kept up to date by every insertion and removal, in time
+   *  proportional to the number of species in z.
+   */
+  std::list<std::pair<std::string, int> > get_species_in_zipcode( int zipcode ) const;
+
   std::list<std::string> get_all_near( double latitude, double longitude, double distance ) const;
 
 private:
+  friend class TreeSnapshot;
+
   // class Tree_AVL : public AvlTree<Tree> {
   // public:
   //   std::list<std::string> find_all_species( const std::string& spc_name ) const;
@@ -61,23 +174,133 @@ private:
   //   std::list<std::string> find_all_species( const std::string& spc_name, AvlNode *t) const;
 
   // };
-  AvlTree<Tree> trees;
+  // the string pools of every tree in the collection; declared before trees
+  // so that it outlives them
+  TreeDictionaries dicts;
+  // the nodes come from large blocks, which makes bulk loads and teardown
+  // of hundreds of thousands of trees much cheaper than new per node
+  Container trees;
   TreeSpecies tree_species;
-  // std::unordered_map<std::string, int> species_map;
-
-  //should use enum class but dont want to keep writing static_cast
-  enum Boros {
-    BRONX = 0,
-    MANHATTAN,
-    BROOKLYN,
-    QUEENS,
-    STATEN_ISLAND,
-    BORO_COUNT
+
+  // the number of trees of a species, in total and in each borough
+  struct SpeciesCounts {
+    int total = 0;
+    BoroughCounts::value_type by_boro;
+  };
+  // the species x borough count matrix, one row per species. The spellings
+  // of a species that differ only in case sort the same and share the row
+  // of the first of them, found through species_row by code and row_of_name
+  // by lowercased name; row_species holds the code of that first spelling.
+  // Kept up to date by every insertion and removal, together with the
+  // number of trees in each borough.
+  std::vector<SpeciesCounts> species_counts;
+  std::vector<int> species_row;
+  std::vector<int> row_species;
+  std::unordered_map<std::string, int> row_of_name;
+  BoroughCounts::value_type boro_totals;
+
+  // for each row, the rows whose names its name matches as a query of
+  // get_matching_species, among the first tested rows. A query for the name
+  // of a species extends the list of its row to every row under
+  // matches_lock, so that repeated queries test each row once and const
+  // queries may run concurrently.
+  struct RowMatches {
+    std::vector<int> rows;
+    size_t tested = 0;
   };
+  mutable std::vector<RowMatches> row_matches;
+  mutable std::mutex matches_lock;
+
+  // gives every species code interned since the last call its row
+  void assign_species_rows();
+
+  // the rows with trees whose names match query, which is lowercased and
+  // without leading whitespace; when query is the name of a row, through
+  // row_matches, and otherwise by matching every row
+  std::vector<int> rows_matching( const std::string& query ) const;
+
+  // the counts of the species of code species, or NULL if it has no row
+  const SpeciesCounts* counts_of( int species ) const;
+
+  // adds delta trees like t to the counts of its species and borough
+  void count_species( const Tree& t, int delta );
+
+  // recounts the matrix and totals from trees, after a bulk change
+  void rebuild_species_counts();
+
+  // the number of trees of one species in a zipcode
+  struct ZipSpecies {
+    int species;    // code of the species
+    int count;
+  };
+  // the species of the trees in each zipcode in ascending tree order, with
+  // spellings that differ only in case listed apart; kept up to date by
+  // every insertion and removal
+  std::unordered_map<int, std::vector<ZipSpecies> > zip_species;
+
+  // true if the trees of species code a sort before those of code b
+  bool species_before( int a, int b ) const;
+
+  // adds delta trees like t to the histogram of its zipcode
+  void count_in_zipcode( const Tree& t, int delta );
+
+  // recounts zip_species from trees, after a bulk change
+  void rebuild_zip_species();
+
+  // the scanned fields of trees, in the same order, and the rows of
+  // columns by position. The bulk changes, add_trees and remove_if,
+  // rebuild them at once. add_tree and remove_tree, for which a rebuild
+  // would cost O(n) each, only mark them stale, and the next scanning
+  // query rebuilds them under columns_lock, so that const queries may
+  // run concurrently; a query concurrent with a change is not safe.
+  mutable TreeColumns columns;
+  mutable TreeGrid grid;
+  mutable std::atomic<bool> columns_stale{true};
+  mutable std::mutex columns_lock;
+
+  // rebuilds columns and grid from trees
+  void rebuild_columns() const;
+
+  // returns columns, first rebuilding them and grid if trees has changed
+  const TreeColumns& column_view() const;
+
+  // a key with the species of code species in dicts and the given id; with
+  // INT_MIN and INT_MAX it sorts just before and just after every tree of
+  // the species. Query names are looked up with dicts.species.find first,
+  // so that no pool grows with them.
+  Tree species_key( int species, int id ) const;
+
+  // a run of rows, in tree order, whose trees have equal species keys
+  struct SpeciesRun {
+    int species;    // code of the species of the run's first tree
+    int begin;      // rank of the run's first tree
+    int end;        // one past the rank of its last tree
+  };
+
+  // the species runs of the collection in tree order, found by jumping
+  // from one run to the next in O(log n) each
+  std::vector<SpeciesRun> species_runs() const;
+
+  // removes from tree_species the species that no tree has any more
+  void forget_missing_species();
 
   size_t size = 0;
+  unsigned num_threads = 1;    // for full scans
 
 
 };
 
+template <class Predicate>
+int TreeCollection::remove_if( const Predicate& p ) {
+  int removed = trees.removeIf(p);
+  if (removed > 0) {
+    size -= removed;
+    rebuild_columns();
+    rebuild_species_counts();
+    rebuild_zip_species();
+    forget_missing_species();
+  }
+  return removed;
+}
+
 #endif /* _TREE_COLLECTION_H_ */
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*******************************************************************************
+  Title          : tree_columns.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the TreeColumns class
+  Purpose        : To keep the fields of a collection of trees that queries
+                   scan in one contiguous array per field.
+  Usage          :
+  Build with     : -std=c++11
+*******************************************************************************/
+#include "tree_columns.h"
+
+void TreeColumns::reserve( size_t rows ) {
+  tree_id.reserve(rows);
+  tree_dbh.reserve(rows);
+  species.reserve(rows);
+  zipcode.reserve(rows);
+  boro.reserve(rows);
+  latitude.reserve(rows);
+  longitude.reserve(rows);
+}
+
+void TreeColumns::push_back( const Tree& t ) {
+  double lat, lon;
+  t.get_position(lat, lon);
+  tree_id.push_back(t.id());
+  tree_dbh.push_back(t.diameter());
+  species.push_back(t.species_code());
+  zipcode.push_back(t.zip_code());
+  boro.push_back(t.boro_code());
+  latitude.push_back(lat);
+  longitude.push_back(lon);
+}
+
+void TreeColumns::clear() {
+  tree_id.clear();
+  tree_dbh.clear();
+  species.clear();
+  zipcode.clear();
+  boro.clear();
+  latitude.clear();
+  longitude.clear();
+}
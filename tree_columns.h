@@ -0,0 +1,51 @@
+/*******************************************************************************
+  Title          : tree_columns.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the TreeColumns class
+  Purpose        : To keep the fields of a collection of trees that queries
+                   scan in one contiguous array per field.
+  Usage          :
+  Build with     :
+*******************************************************************************/
+#ifndef _TREE_COLUMNS_H_
+#define _TREE_COLUMNS_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "tree.h"
+
+/** class TreeColumns
+ *  A struct-of-arrays copy of a sorted sequence of trees, filled by
+ *  push_back in tree order. Row i of every
+ *  column belongs to the i-th tree in (species, id) order, so a scan that
+ *  reads one or two fields streams through memory instead of visiting
+ *  every node of the tree. The species codes refer to the TreeDictionaries
+ *  of the trees that were copied, which must outlive the columns.
+ */
+class TreeColumns {
+public:
+  std::vector<int>      tree_id;
+  std::vector<int>      tree_dbh;
+  std::vector<uint32_t> species;
+  std::vector<int>      zipcode;
+  std::vector<uint8_t>  boro;      // Borough values
+  std::vector<double>   latitude;
+  std::vector<double>   longitude;
+
+  /** reserve(rows) makes room for rows rows in every column */
+  void reserve( size_t rows );
+
+  /** push_back(t) appends the fields of t as the last row */
+  void push_back( const Tree& t );
+
+  /** clear() empties every column */
+  void clear();
+
+  /** size() returns the number of rows */
+  size_t size() const { return tree_id.size(); }
+};
+
+#endif /* _TREE_COLUMNS_H_ */
@@ -0,0 +1,82 @@
+/*******************************************************************************
+  Title          : tree_grid.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the TreeGrid class
+  Purpose        : To find the trees in a latitude/longitude box without
+                   looking at every tree of the city.
+  Usage          :
+  Build with     : -std=c++11
+*******************************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#include "tree_grid.h"
+
+constexpr double TreeGrid::LAT_MIN;
+constexpr double TreeGrid::LAT_MAX;
+constexpr double TreeGrid::LON_MIN;
+constexpr double TreeGrid::LON_MAX;
+constexpr double TreeGrid::LAT_STEP;
+constexpr double TreeGrid::LON_STEP;
+
+int TreeGrid::cell_of( double lat, double lon ) {
+  // written so that NaN fails the test
+  if (!(lat >= LAT_MIN && lat < LAT_MAX && lon >= LON_MIN && lon < LON_MAX))
+    return OUTSIDE;
+  int band = std::min(BANDS - 1, static_cast<int>((lat - LAT_MIN) / LAT_STEP));
+  int column = std::min(COLUMNS - 1, static_cast<int>((lon - LON_MIN) / LON_STEP));
+  return band * COLUMNS + column;
+}
+
+// A counting sort of the rows by cell, with the rows outside the grid in a
+// last cell of their own; going through the rows in order leaves each
+// cell's rows ascending.
+void TreeGrid::build( const TreeColumns& c ) {
+  std::vector<int> cell(c.size());
+  cell_start.assign(OUTSIDE + 2, 0);
+  for ( size_t i = 0; i < c.size(); ++i ) {
+    cell[i] = cell_of(c.latitude[i], c.longitude[i]);
+    ++cell_start[cell[i] + 1];
+  }
+  for ( int k = 0; k <= OUTSIDE; ++k )
+    cell_start[k + 1] += cell_start[k];
+
+  rows.resize(c.size());
+  std::vector<int> next(cell_start.begin(), cell_start.end() - 1);
+  for ( size_t i = 0; i < c.size(); ++i )
+    rows[next[cell[i]]++] = i;
+
+  trig.clear();
+  trig.reserve(rows.size());
+  for ( int r : rows )
+    trig.push_back(c.latitude[r], c.longitude[r]);
+}
+
+std::vector<TreeGrid::Span> TreeGrid::spans_in_box( double lat_lo, double lat_hi,
+                                                    double lon_lo, double lon_hi ) const {
+  std::vector<Span> spans;
+  if (rows.empty())
+    return spans;
+  // the bands and columns overlapping the box, clamped to the grid
+  auto index = []( double x, int count ) {
+    return static_cast<int>(std::min(count - 1.0, std::max(0.0, std::floor(x))));
+  };
+  int band_lo = index((lat_lo - LAT_MIN) / LAT_STEP, BANDS);
+  int band_hi = index((lat_hi - LAT_MIN) / LAT_STEP, BANDS);
+  int col_lo = index((lon_lo - LON_MIN) / LON_STEP, COLUMNS);
+  int col_hi = index((lon_hi - LON_MIN) / LON_STEP, COLUMNS);
+  bool overlaps = lat_hi >= LAT_MIN && lat_lo < LAT_MAX &&
+                  lon_hi >= LON_MIN && lon_lo < LON_MAX;
+  if (overlaps) {
+    for ( int band = band_lo; band <= band_hi; ++band ) {
+      int first = cell_start[band * COLUMNS + col_lo];
+      int last = cell_start[band * COLUMNS + col_hi + 1];
+      if (first != last)
+        spans.push_back(Span(first, last));
+    }
+  }
+  if (cell_start[OUTSIDE] != cell_start[OUTSIDE + 1])
+    spans.push_back(Span(cell_start[OUTSIDE], cell_start[OUTSIDE + 1]));
+  return spans;
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+  Title          : tree_grid.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the TreeGrid class
+  Purpose        : To find the trees in a latitude/longitude box without
+                   looking at every tree of the city.
+  Usage          :
+  Build with     :
+*******************************************************************************/
+#ifndef _TREE_GRID_H_
+#define _TREE_GRID_H_
+
+#include <vector>
+#include <utility>
+
+#include "haversine.h"
+#include "tree_columns.h"
+
+/** class TreeGrid
+ *  A uniform grid of cells about 250 m on a side over New York City,
+ *  holding the rows of a TreeColumns. The rows are laid out cell by cell,
+ *  each cell's in ascending order, with the cells of one band of latitude
+ *  following each other from west to east, so the cells of a band that
+ *  overlap a box are one contiguous span of positions. Rows whose position
+ *  is outside the city, or not a number, come last.
+ *
+ *  points() gives the sines and cosines of the rows' coordinates in the
+ *  same layout, for haversine_select.
+ */
+class TreeGrid {
+public:
+  typedef std::pair<int, int> Span;    // positions [first,second)
+
+  /** build(c) indexes every row of c by its position, in linear time */
+  void build( const TreeColumns& c );
+
+  /** spans_in_box(lat_lo,lat_hi,lon_lo,lon_hi) returns the positions of
+   *  the cells overlapping the box, one span per band of latitude, followed
+   *  by those outside the grid. Every row inside the box is in a span; rows
+   *  near the box are too, so a caller must test each row it is given.
+   */
+  std::vector<Span> spans_in_box( double lat_lo, double lat_hi,
+                                  double lon_lo, double lon_hi ) const;
+
+  /** row(k) returns the row at position k */
+  int row( int k ) const { return rows[k]; }
+
+  /** points() returns the trigonometry of the rows, by position */
+  const HaversinePoints& points() const { return trig; }
+
+private:
+  static constexpr double LAT_MIN = 40.45;
+  static constexpr double LAT_MAX = 40.95;
+  static constexpr double LON_MIN = -74.30;
+  static constexpr double LON_MAX = -73.65;
+  static constexpr double LAT_STEP = 0.00225;   // about 250 m
+  static constexpr double LON_STEP = 0.003;     // about 250 m at 40.7 N
+  static const int BANDS = 223;                 // ceil((LAT_MAX-LAT_MIN)/LAT_STEP)
+  static const int COLUMNS = 217;               // ceil((LON_MAX-LON_MIN)/LON_STEP)
+  static const int OUTSIDE = BANDS * COLUMNS;   // the cell of rows outside the grid
+
+  // the cell of a position, or OUTSIDE
+  static int cell_of( double lat, double lon );
+
+  std::vector<int> cell_start;    // positions [cell_start[k],cell_start[k+1]) are in cell k
+  std::vector<int> rows;          // by position
+  HaversinePoints trig;           // by position
+};
+
+#endif /* _TREE_GRID_H_ */
@@ -0,0 +1,134 @@
+/*******************************************************************************
+  Title          : tree_loader.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the TreeLoader class
+  Purpose        : To read the tree census file into a TreeCollection by
+                   memory-mapping it and parsing each row in place.
+  Usage          : 
+  Build with     : -std=c++11
+*******************************************************************************/
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tree_loader.h"
+#include "tree.h"
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open( const std::string& path ) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  length = static_cast<size_t>(info.st_size);
+  if (length > 0) {
+    void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      length = 0;
+      return false;
+    }
+    madvise(p, length, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(p);
+  }
+  ::close(fd);
+  return true;
+}
+
+void MappedFile::close() {
+  if (data != nullptr)
+    munmap(const_cast<char*>(data), length);
+  data = nullptr;
+  length = 0;
+}
+
+TreeLoader::TreeLoader( unsigned threads ) : num_threads(threads) {
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool TreeLoader::load( const std::string& path, TreeCollection& trees ) {
+  MappedFile file;
+  if (!file.open(path))
+    return false;
+  load(file.begin(), file.end(), trees);
+  return true;
+}
+
+// returns the start of the line following p, or last
+static const char* next_line( const char* p, const char* last ) {
+  const char* eol = static_cast<const char*>(std::memchr(p, '\n', last - p));
+  return eol == NULL ? last : eol + 1;
+}
+
+void TreeLoader::parse_range( const char* first, const char* last, Batch& batch ) {
+  while (first != last) {
+    const char* eol = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    if (eol == NULL)
+      eol = last;
+
+    batch.trees.emplace_back(first, eol, batch.dicts, &batch.errors);
+    batch.rows++;
+    if (0 == batch.trees.back().id()) {
+      batch.trees.pop_back();
+      batch.bad++;
+    }
+
+    first = eol == last ? last : eol + 1;
+  }
+}
+
+void TreeLoader::load( const char* first, const char* last, TreeCollection& trees ) {
+  const size_t MIN_RANGE_BYTES = 1 << 20;
+
+  // cut the buffer into roughly equal ranges that each start on a new line
+  size_t size = last - first;
+  size_t ranges = std::min<size_t>(num_threads, size / MIN_RANGE_BYTES + 1);
+  std::vector<const char*> bounds(1, first);
+  for ( size_t i = 1; i < ranges; ++i ) {
+    const char* p = std::max(bounds.back(), first + size * i / ranges);
+    bounds.push_back(p == first ? first : next_line(p - 1, last));
+  }
+  bounds.push_back(last);
+
+  std::vector<Batch> batches(ranges);
+  if (ranges == 1) {
+    parse_range(first, last, batches[0]);
+  } else {
+    std::vector<std::thread> workers;
+    for ( size_t i = 0; i < ranges; ++i )
+      workers.emplace_back(parse_range, bounds[i], bounds[i + 1], std::ref(batches[i]));
+    for ( auto& w : workers )
+      w.join();
+  }
+
+  // the batches are joined in file order and bulk-loaded together
+  std::vector<Tree> all;
+  all.swap(batches[0].trees);
+  for ( auto& batch : batches ) {
+    rows += batch.rows;
+    bad += batch.bad;
+    parse_errors.add(batch.errors);
+    std::move(batch.trees.begin(), batch.trees.end(), std::back_inserter(all));
+    std::vector<Tree>().swap(batch.trees);
+  }
+  added += trees.add_trees(all, num_threads);
+}
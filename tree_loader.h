@@ -0,0 +1,95 @@
+/*******************************************************************************
+  Title          : tree_loader.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the TreeLoader class
+  Purpose        : To read the tree census file into a TreeCollection by
+                   memory-mapping it and parsing each row in place.
+  Usage          : 
+  Build with     : 
+*******************************************************************************/
+#ifndef _TREE_LOADER_H_
+#define _TREE_LOADER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "tree_collection.h"
+
+/** class MappedFile
+ *  A read-only memory mapping of an entire file. The mapping is released
+ *  when the object is closed or destroyed.
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile( const MappedFile& ) = delete;
+  MappedFile& operator=( const MappedFile& ) = delete;
+
+  // maps the file at path; returns false if it cannot be opened or mapped
+  bool open( const std::string& path );
+
+  void close();
+
+  const char* begin() const { return data; }
+  const char* end() const { return data + length; }
+  size_t size() const { return length; }
+
+private:
+  const char* data = nullptr;
+  size_t length = 0;
+};
+
+
+/** class TreeLoader
+ *  Builds the trees of a census file straight from its mapped bytes and adds
+ *  them to a TreeCollection, one row per line. Rows that do not produce a
+ *  valid tree are skipped; the problems found in them are counted by field
+ *  and can be retrieved with errors() once loading is done.
+ *
+ *  With more than one thread, the buffer is cut into newline-aligned byte
+ *  ranges that are parsed concurrently into one batch per range. The batches
+ *  are then joined in file order and bulk-loaded into the collection, so the
+ *  result is exactly the same as adding the rows one at a time.
+ */
+class TreeLoader {
+public:
+  // num_threads == 0 uses one thread per hardware core
+  explicit TreeLoader( unsigned num_threads = 1 );
+
+  // loads the file at path into trees; returns false if it cannot be read
+  bool load( const std::string& path, TreeCollection& trees );
+
+  // loads the rows in [first,last) into trees
+  void load( const char* first, const char* last, TreeCollection& trees );
+
+  int rows_read() const { return rows; }
+  int trees_added() const { return added; }
+  int bad_rows() const { return bad; }
+  const TreeParseErrors& errors() const { return parse_errors; }
+  unsigned threads() const { return num_threads; }
+
+private:
+  // the trees parsed from one byte range, in file order, with the string
+  // pools they were parsed into
+  struct Batch {
+    TreeDictionaries dicts;
+    std::vector<Tree> trees;
+    int rows = 0;
+    int bad = 0;
+    TreeParseErrors errors;
+  };
+
+  static void parse_range( const char* first, const char* last, Batch& batch );
+
+  unsigned num_threads;
+  int rows = 0;
+  int added = 0;
+  int bad = 0;
+  TreeParseErrors parse_errors;
+};
+
+#endif /* _TREE_LOADER_H_ */
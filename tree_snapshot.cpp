@@ -0,0 +1,261 @@
+/*******************************************************************************
+  Title          : tree_snapshot.cpp
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The implementation file for the TreeSnapshot class
+  Purpose        : To save a loaded TreeCollection to a compact binary file
+                   and load it back without parsing the census csv again.
+  Usage          : 
+  Build with     : -std=c++11
+*******************************************************************************/
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+
+#include "tree_snapshot.h"
+#include "tree_loader.h"
+#include "tree.h"
+
+namespace {
+
+const char MAGIC[8] = { 'N', 'Y', 'C', 'T', 'R', 'E', 'E', 'S' };
+const uint32_t BYTE_ORDER_TAG = 0x01020304;
+
+struct Header {
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t tree_count;
+  uint32_t string_count;
+  uint64_t string_bytes;
+  uint64_t payload_size;   // bytes after the header
+  uint64_t checksum;       // of the payload
+};
+
+// a 64-bit FNV-1a style hash taken a word at a time
+uint64_t checksum( const char* p, size_t n ) {
+  const uint64_t PRIME = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for ( ; n >= 8; p += 8, n -= 8 ) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    h = (h ^ word) * PRIME;
+  }
+  for ( ; n > 0; ++p, --n )
+    h = (h ^ static_cast<unsigned char>(*p)) * PRIME;
+  return h;
+}
+
+size_t align8( size_t n ) {
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+// true if a payload of payload_size bytes is large enough for the counts
+// of h, so that the offsets of a Layout built from them cannot overflow;
+// it is checked before any of those offsets is used
+bool counts_fit( const Header& h, uint64_t payload_size ) {
+  const uint64_t ROW_BYTES = 8 * 4 + 2 * 8;    // one entry of every column
+  return payload_size <= SIZE_MAX / 4
+      && h.string_bytes <= payload_size
+      && 4 * (static_cast<uint64_t>(h.string_count) + 1) <= payload_size
+      && ROW_BYTES * h.tree_count <= payload_size;
+}
+
+// the byte offsets of each section of the payload, given the counts
+struct Layout {
+  size_t offsets, strings, tree_id, tree_dbh, zipcode, status, health, 
+         spc_common, address, boroname, latitude, longitude, size;
+
+  Layout( size_t trees, size_t string_count, size_t string_bytes ) {
+    offsets    = 0;
+    strings    = align8(offsets + 4 * (string_count + 1));
+    tree_id    = align8(strings + string_bytes);
+    tree_dbh   = align8(tree_id + 4 * trees);
+    zipcode    = align8(tree_dbh + 4 * trees);
+    status     = align8(zipcode + 4 * trees);
+    health     = align8(status + 4 * trees);
+    spc_common = align8(health + 4 * trees);
+    address    = align8(spc_common + 4 * trees);
+    boroname   = align8(address + 4 * trees);
+    latitude   = align8(boroname + 4 * trees);
+    longitude  = latitude + 8 * trees;
+    size       = longitude + 8 * trees;
+  }
+};
+
+// assigns each distinct string a code in order of first appearance
+class Dictionary {
+public:
+  uint32_t code( const std::string& s ) {
+    auto it = codes.find(s);
+    if (it != codes.end())
+      return it->second;
+    uint32_t c = static_cast<uint32_t>(strings.size());
+    codes.emplace(s, c);
+    strings.push_back(s);
+    bytes += s.size();
+    return c;
+  }
+
+  std::vector<std::string> strings;
+  size_t bytes = 0;
+
+private:
+  std::unordered_map<std::string, uint32_t> codes;
+};
+
+template <class T>
+void put( std::vector<char>& out, size_t offset, const std::vector<T>& column ) {
+  if (!column.empty())
+    std::memcpy(&out[offset], column.data(), column.size() * sizeof(T));
+}
+
+template <class T>
+const T* column_at( const char* payload, size_t offset ) {
+  return reinterpret_cast<const T*>(payload + offset);
+}
+
+} // namespace
+
+bool TreeSnapshot::save( const TreeCollection& collection, const std::string& path ) {
+  Dictionary dict;
+  std::vector<int32_t> tree_id, tree_dbh, zipcode;
+  std::vector<uint32_t> status, health, spc_common, address, boroname;
+  std::vector<double> latitude, longitude;
+
+  collection.trees.visitInOrder([&](const Tree& t) {
+    double lat, lon;
+    t.get_position(lat, lon);
+    tree_id.push_back(t.id());
+    tree_dbh.push_back(t.diameter());
+    zipcode.push_back(t.zip_code());
+    status.push_back(dict.code(t.life_status()));
+    health.push_back(dict.code(t.tree_health()));
+    spc_common.push_back(dict.code(t.common_name()));
+    address.push_back(dict.code(t.nearest_address()));
+    boroname.push_back(dict.code(t.borough_name()));
+    latitude.push_back(lat);
+    longitude.push_back(lon);
+  });
+
+  size_t n = tree_id.size();
+  Layout layout(n, dict.strings.size(), dict.bytes);
+  std::vector<char> payload(layout.size, 0);
+
+  std::vector<uint32_t> offsets(1, 0);
+  size_t pos = layout.strings;
+  for ( const auto& s : dict.strings ) {
+    if (!s.empty())
+      std::memcpy(&payload[pos], s.data(), s.size());
+    pos += s.size();
+    offsets.push_back(static_cast<uint32_t>(pos - layout.strings));
+  }
+  put(payload, layout.offsets, offsets);
+  put(payload, layout.tree_id, tree_id);
+  put(payload, layout.tree_dbh, tree_dbh);
+  put(payload, layout.zipcode, zipcode);
+  put(payload, layout.status, status);
+  put(payload, layout.health, health);
+  put(payload, layout.spc_common, spc_common);
+  put(payload, layout.address, address);
+  put(payload, layout.boroname, boroname);
+  put(payload, layout.latitude, latitude);
+  put(payload, layout.longitude, longitude);
+
+  Header header;
+  std::memset(&header, 0, sizeof header);
+  std::memcpy(header.magic, MAGIC, sizeof MAGIC);
+  header.version = VERSION;
+  header.byte_order = BYTE_ORDER_TAG;
+  header.tree_count = static_cast<uint32_t>(n);
+  header.string_count = static_cast<uint32_t>(dict.strings.size());
+  header.string_bytes = dict.bytes;
+  header.payload_size = payload.size();
+  header.checksum = checksum(payload.data(), payload.size());
+
+  // written beside path and renamed over it, so that path holds either
+  // its old contents or the whole snapshot
+  std::string temp = path + ".tmp";
+  std::ofstream out(temp.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof header);
+  out.write(payload.data(), payload.size());
+  out.close();
+  if (!out || std::rename(temp.c_str(), path.c_str()) != 0) {
+    std::remove(temp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TreeSnapshot::is_snapshot( const std::string& path ) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  char magic[sizeof MAGIC];
+  return in.read(magic, sizeof magic) && std::memcmp(magic, MAGIC, sizeof MAGIC) == 0;
+}
+
+bool TreeSnapshot::load( const std::string& path, TreeCollection& collection ) {
+  MappedFile file;
+  if (!file.open(path) || file.size() < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, file.begin(), sizeof header);
+  if (std::memcmp(header.magic, MAGIC, sizeof MAGIC) != 0
+      || header.version != VERSION
+      || header.byte_order != BYTE_ORDER_TAG
+      || header.payload_size != file.size() - sizeof header
+      || !counts_fit(header, header.payload_size))
+    return false;
+
+  Layout layout(header.tree_count, header.string_count, header.string_bytes);
+  const char* payload = file.begin() + sizeof header;
+  if (layout.size != header.payload_size
+      || checksum(payload, header.payload_size) != header.checksum)
+    return false;
+
+  const uint32_t* offsets = column_at<uint32_t>(payload, layout.offsets);
+  const char* chars = payload + layout.strings;
+  if (offsets[header.string_count] != header.string_bytes)
+    return false;
+  std::vector<std::string> strings;
+  strings.reserve(header.string_count);
+  for ( uint32_t i = 0; i < header.string_count; ++i ) {
+    if (offsets[i] > offsets[i + 1])
+      return false;
+    strings.emplace_back(chars + offsets[i], chars + offsets[i + 1]);
+  }
+
+  const int32_t*  tree_id    = column_at<int32_t>(payload, layout.tree_id);
+  const int32_t*  tree_dbh   = column_at<int32_t>(payload, layout.tree_dbh);
+  const int32_t*  zipcode    = column_at<int32_t>(payload, layout.zipcode);
+  const uint32_t* status     = column_at<uint32_t>(payload, layout.status);
+  const uint32_t* health     = column_at<uint32_t>(payload, layout.health);
+  const uint32_t* spc_common = column_at<uint32_t>(payload, layout.spc_common);
+  const uint32_t* address    = column_at<uint32_t>(payload, layout.address);
+  const uint32_t* boroname   = column_at<uint32_t>(payload, layout.boroname);
+  const double*   latitude   = column_at<double>(payload, layout.latitude);
+  const double*   longitude  = column_at<double>(payload, layout.longitude);
+
+  for ( uint32_t i = 0; i < header.tree_count; ++i ) {
+    if (status[i] >= strings.size() || health[i] >= strings.size() 
+        || spc_common[i] >= strings.size() || address[i] >= strings.size()
+        || boroname[i] >= strings.size())
+      return false;
+  }
+
+  // the rows are already in key order, so they are bulk-loaded unsorted
+  std::vector<Tree> batch;
+  batch.reserve(header.tree_count);
+  for ( uint32_t i = 0; i < header.tree_count; ++i ) {
+    batch.emplace_back(tree_id[i], tree_dbh[i], strings[status[i]], strings[health[i]],
+                       strings[spc_common[i]], zipcode[i], strings[address[i]],
+                       strings[boroname[i]], latitude[i], longitude[i],
+                       &collection.dicts);
+  }
+  collection.add_trees(batch);
+  return true;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+  Title          : tree_snapshot.h
+  Author         : Ajani Stewart
+  Created on     : October 17, 2026
+  Description    : The interface file for the TreeSnapshot class
+  Purpose        : To save a loaded TreeCollection to a compact binary file
+                   and load it back without parsing the census csv again.
+  Usage          : 
+  Build with     : 
+*******************************************************************************/
+#ifndef _TREE_SNAPSHOT_H_
+#define _TREE_SNAPSHOT_H_
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "tree_collection.h"
+
+/** class TreeSnapshot
+ *  Reads and writes tree snapshot files. A snapshot holds the trees of a
+ *  collection in sorted key order as fixed-width columns, with every string
+ *  stored once in a dictionary and referred to by its index:
+ *
+ *     header      magic, version, byte-order tag, counts, payload checksum
+ *     dictionary  uint32 offsets[strings + 1], then the string bytes
+ *     columns     int32 tree_id, tree_dbh, zipcode; 
+ *                 uint32 status, health, spc_common, address, boroname;
+ *                 double latitude, longitude   (one array each, n entries)
+ *
+ *  Every section starts on an 8-byte boundary. Numbers are in the byte order
+ *  of the machine that wrote the file, which the tag lets a reader check.
+ *  The file is read through a memory map and rejected if the version, sizes
+ *  or checksum do not match; the counts of the header are checked against
+ *  the size of the file before any section is located. A snapshot is
+ *  written to a temporary file that is then renamed over the target.
+ */
+class TreeSnapshot {
+public:
+  static const uint32_t VERSION = 1;
+
+  /** save(trees,path) writes trees to the snapshot file path, through
+   *  path.tmp, leaving path as it was if the file cannot be written
+   *  @return bool  true if the file was written
+   */
+  static bool save( const TreeCollection& trees, const std::string& path );
+
+  /** load(path,trees) adds the trees of the snapshot file path to trees
+   *  @return bool  true if path is a valid snapshot; trees is unchanged if not
+   */
+  static bool load( const std::string& path, TreeCollection& trees );
+
+  /** is_snapshot(path) checks whether path starts with the snapshot magic */
+  static bool is_snapshot( const std::string& path );
+};
+
+#endif /* _TREE_SNAPSHOT_H_ */
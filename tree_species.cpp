@@ -37,15 +37,20 @@ int TreeSpecies::add_species( const std::string& s ) {
   return 0;
 }
 
-//checks if they are the same, ignoring case
+int TreeSpecies::remove_species( const std::string& s ) {
+  auto it = std::lower_bound(species.begin(), species.end(), s);
+  if (it == species.end() || *it != s)
+    return 0;
+  species.erase(it);
+  return 1;
+}
+
+// checks if the n characters at s and p are the same, ignoring case
 // hyphens and spaces are treated as the same character
-bool is_same_species( const std::string& s_name, const std::string& p_name ) {
-  if ( s_name.size() != p_name.size() )
-    return false;
-  
-  for ( size_t i = 0; i < s_name.size(); ++i ) {
-    char p_i = p_name[i];
-    char s_i = s_name[i];
+static bool same_species_chars( const char* s, const char* p, size_t n ) {
+  for ( size_t i = 0; i < n; ++i ) {
+    char p_i = p[i];
+    char s_i = s[i];
     if ( s_i != p_i && (s_i != '-' && s_i != ' ') 
         && (p_i != '-' && p_i != ' ')) {
           return false;
@@ -54,28 +59,24 @@ bool is_same_species( const std::string& s_name, const std::string& p_name ) {
   return true;
 }
 
-std::vector<std::string> split_on_space_or_hyphen(const std::string& s) {
-  std::vector<std::string> result;
-  std::string cur_str;
-
-  std::for_each(s.begin(), s.end(), [&](char c) {
-    if (c == '-' || c == ' ') {
-      result.push_back(cur_str);
-      cur_str = "";
-    } else {
-      cur_str += c;
-    }
-  });
-  result.push_back(cur_str);
-  return result;
+//checks if they are the same, ignoring case
+// hyphens and spaces are treated as the same character
+bool is_same_species( const std::string& s_name, const std::string& p_name ) {
+  if ( s_name.size() != p_name.size() )
+    return false;
+  return same_species_chars(s_name.data(), p_name.data(), s_name.size());
 }
 
+// checks each word of s_name, as split on spaces and hyphens, in place
 bool contains_word( const std::string& s_name, const std::string& p_name ) {
-  auto string_array = split_on_space_or_hyphen(s_name);
-
-  for (size_t i = 0; i < string_array.size(); ++i) {
-    if (is_same_species(string_array[i], p_name))
+  size_t start = 0;
+  for (size_t i = 0; i <= s_name.size(); ++i) {
+    if (i < s_name.size() && s_name[i] != '-' && s_name[i] != ' ')
+      continue;
+    if (i - start == p_name.size() &&
+        same_species_chars(s_name.data() + start, p_name.data(), p_name.size()))
       return true;
+    start = i + 1;
   }
 
   return false;
@@ -99,8 +100,11 @@ std::string alternate_hyphens_and_spaces( const std::string& s) {
 bool contains_subsequence( const std::string& s_name, const std::string& p_name ) {
   if (p_name.size() > s_name.size()) return false;
 
+  // the alternate spelling differs only if p_name has a space or hyphen
   auto result = s_name.find(p_name);
   if (result == s_name.npos) {
+    if (p_name.find_first_of(" -") == p_name.npos)
+      return false;
     result = s_name.find(alternate_hyphens_and_spaces(p_name));
     if (result == s_name.npos){
       return false;
@@ -129,9 +133,10 @@ bool is_matching_species( const std::string& spc_name, const std::string& partia
   // case 1: spc_name == partial name
   // case 2: p_name is one word -> then p_name is exactly one of the words on s_name
   // case 3: if p_name isnt one word -> then p_name is a subsequence of s_name
-  auto s_name = tolower(spc_name);
-  auto p_name = tolower(partial_name);
-  
+  return is_matching_lowercase_species(tolower(spc_name), tolower(partial_name));
+}
+
+bool is_matching_lowercase_species( const std::string& s_name, const std::string& p_name ) {
   return is_same_species(s_name, p_name) || contains_word(s_name, p_name)
          || contains_subsequence(s_name, p_name);
 }
@@ -27,6 +27,9 @@ public:
 
   int add_species( const string& species );
 
+  // removes species s; returns 1 if it was there and 0 if it was not
+  int remove_species( const string& species );
+
   std::list<std::string> get_matching_species( const std::string& partial_name ) const;
 
   bool contains( const std::string& s);
@@ -36,3 +39,7 @@ private:
 };
 
 bool is_matching_species( const std::string& spc_name, const std::string& partial_name );
+
+// is_matching_species for names that are already lowercase; it does not
+// copy them
+bool is_matching_lowercase_species( const std::string& spc_name, const std::string& partial_name );